@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <fmt/format.h>
+
+#include "Aggregate.hpp"
+
+auto stringToAggregateFunction(const std::string& s) -> std::optional<AggregateFunction> {
+    static const std::unordered_map<std::string, AggregateFunction> fmap = {
+        {"COUNT", AggregateFunction::COUNT},
+        {"SUM", AggregateFunction::SUM},
+        {"MIN", AggregateFunction::MIN},
+        {"MAX", AggregateFunction::MAX},
+        {"AVG", AggregateFunction::AVG},
+    };
+    auto upper = s;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    auto it = fmap.find(upper);
+    if (it == fmap.end()) return std::nullopt;
+    return it->second;
+}
+
+auto aggregateFunctionToString(AggregateFunction f) -> std::string {
+    switch (f) {
+        case AggregateFunction::COUNT: return "COUNT";
+        case AggregateFunction::SUM: return "SUM";
+        case AggregateFunction::MIN: return "MIN";
+        case AggregateFunction::MAX: return "MAX";
+        case AggregateFunction::AVG: return "AVG";
+    }
+    throw std::runtime_error("unknown aggregate function");
+}
+
+auto AggregateExpr::toString() const -> std::string {
+    return fmt::format("{}({})", aggregateFunctionToString(function), column_name);
+}
+
+auto Accumulator::update(const Value& v) -> void {
+    if (v.isNull()) return; // nulls are ignored by every aggregate except COUNT(*)
+    count++;
+    switch (v.getType()) {
+        case DataType::INTEGER:
+            int_sum += v.get<int>();
+            break;
+        case DataType::FLOAT:
+            float_sum += v.get<double>();
+            has_float = true;
+            break;
+        default:
+            break;
+    }
+    if (min.isNull() || v < min) min = v;
+    if (max.isNull() || max < v) max = v;
+}
+
+auto Accumulator::merge(const Accumulator& other) -> void {
+    count += other.count;
+    int_sum += other.int_sum;
+    float_sum += other.float_sum;
+    has_float = has_float || other.has_float;
+    if (!other.min.isNull() && (min.isNull() || other.min < min)) min = other.min;
+    if (!other.max.isNull() && (max.isNull() || max < other.max)) max = other.max;
+}
+
+auto Accumulator::finalize(AggregateFunction function) const -> Value {
+    switch (function) {
+        case AggregateFunction::COUNT:
+            return Value(static_cast<int>(count));
+        case AggregateFunction::SUM:
+            if (count == 0) return Value::Null();
+            if (has_float) return Value(float_sum + static_cast<double>(int_sum));
+            if (int_sum < std::numeric_limits<int>::min() || int_sum > std::numeric_limits<int>::max()) {
+                return Value(static_cast<double>(int_sum)); // doesn't fit INTEGER anymore
+            }
+            return Value(static_cast<int>(int_sum));
+        case AggregateFunction::AVG:
+            if (count == 0) return Value::Null();
+            return Value((float_sum + static_cast<double>(int_sum)) / static_cast<double>(count));
+        case AggregateFunction::MIN:
+            return min;
+        case AggregateFunction::MAX:
+            return max;
+    }
+    throw std::runtime_error("unknown aggregate function");
+}
+
+auto HashAggregator::makeKey(const Row& row) const -> GroupKey {
+    GroupKey key;
+    key.reserve(group_by_.size());
+    for (const auto& col : group_by_) {
+        key.push_back(row.hasColumn(col) ? row.getValue(col) : Value::Null());
+    }
+    return key;
+}
+
+auto HashAggregator::accumulate(std::vector<Accumulator>& accs, const Row& row) const -> void {
+    for (size_t i = 0; i < aggregates_.size(); i++) {
+        const auto& agg = aggregates_[i];
+        if (agg.column_name == "*") {
+            accs[i].count++;
+        } else if (row.hasColumn(agg.column_name)) {
+            accs[i].update(row.getValue(agg.column_name));
+        }
+    }
+}
+
+auto HashAggregator::finalizeInto(const GroupTable& table, AggregateResult& out) const -> void {
+    for (const auto& [key, accs] : table) {
+        AggregateGroup group{key, {}};
+        group.values.reserve(aggregates_.size());
+        for (size_t i = 0; i < aggregates_.size(); i++) {
+            group.values.push_back(accs[i].finalize(aggregates_[i].function));
+        }
+        out.push_back(std::move(group));
+    }
+}
+
+auto HashAggregator::partitionOf(size_t hash) -> size_t {
+    return hash >> (std::numeric_limits<size_t>::digits - RADIX_BITS);
+}
+
+auto HashAggregator::aggregate(const RowView& rows, const RowFilter& filter) const -> AggregateResult {
+    GroupTable table;
+    for (const auto& row : rows) {
+        if (filter && !filter(row)) continue;
+        auto [it, _] = table.try_emplace(makeKey(row), aggregates_.size());
+        accumulate(it->second, row);
+    }
+
+    // aggregate without GROUP BY over no rows still yields one row, e.g. COUNT(*) = 0
+    if (table.empty() && group_by_.empty()) {
+        table.try_emplace(GroupKey{}, aggregates_.size());
+    }
+
+    AggregateResult result;
+    result.reserve(table.size());
+    finalizeInto(table, result);
+    return result;
+}
+
+auto HashAggregator::aggregateParallel(const RowView& rows, const RowFilter& filter, size_t threads) const -> AggregateResult {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads <= 1 || rows.size() < PARALLEL_THRESHOLD) {
+        return aggregate(rows, filter);
+    }
+    threads = std::min(threads, (rows.size() + MORSEL_SIZE - 1) / MORSEL_SIZE);
+
+    // phase 1: every worker pulls morsels and pre-aggregates into its own partitioned tables,
+    // so there is no shared state apart from the morsel counter
+    std::vector<std::vector<GroupTable>> local(threads, std::vector<GroupTable>(PARTITION_COUNT));
+    std::vector<std::exception_ptr> errors(threads);
+    std::atomic<size_t> next_morsel{0};
+    GroupKeyHash hasher;
+
+    auto pre_aggregate = [&](size_t worker) {
+        try {
+            auto& partitions = local[worker];
+            while (true) {
+                size_t begin = next_morsel.fetch_add(MORSEL_SIZE, std::memory_order_relaxed);
+                if (begin >= rows.size()) break;
+                size_t end = std::min(begin + MORSEL_SIZE, rows.size());
+                for (size_t i = begin; i < end; i++) {
+                    const Row* visible = rows.get(i);
+                    if (!visible) continue;
+                    const auto& row = *visible;
+                    if (filter && !filter(row)) continue;
+                    auto key = makeKey(row);
+                    auto& table = partitions[partitionOf(hasher(key))];
+                    auto [it, _] = table.try_emplace(std::move(key), aggregates_.size());
+                    accumulate(it->second, row);
+                }
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    // phase 2: partition p of every worker only holds keys of partition p, so partitions
+    // merge independently of each other
+    std::vector<AggregateResult> partition_results(PARTITION_COUNT);
+    std::atomic<size_t> next_partition{0};
+
+    auto merge = [&](size_t worker) {
+        try {
+            while (true) {
+                size_t p = next_partition.fetch_add(1, std::memory_order_relaxed);
+                if (p >= PARTITION_COUNT) break;
+
+                // start from the largest table so the fewest groups get rehashed
+                size_t largest = 0;
+                for (size_t w = 1; w < threads; w++) {
+                    if (local[w][p].size() > local[largest][p].size()) largest = w;
+                }
+                GroupTable merged = std::move(local[largest][p]);
+                for (size_t w = 0; w < threads; w++) {
+                    if (w == largest) continue;
+                    for (auto& [key, accs] : local[w][p]) {
+                        auto [it, inserted] = merged.try_emplace(key);
+                        if (inserted) {
+                            it->second = std::move(accs);
+                        } else {
+                            for (size_t i = 0; i < accs.size(); i++) {
+                                it->second[i].merge(accs[i]);
+                            }
+                        }
+                    }
+                    local[w][p] = GroupTable();
+                }
+                partition_results[p].reserve(merged.size());
+                finalizeInto(merged, partition_results[p]);
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    auto run_phase = [&](auto& phase) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (size_t w = 1; w < threads; w++) {
+            workers.emplace_back(phase, w);
+        }
+        phase(0);
+        for (auto& t : workers) t.join();
+        for (const auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    };
+
+    run_phase(pre_aggregate);
+    run_phase(merge);
+
+    AggregateResult result;
+    size_t total = 0;
+    for (const auto& part : partition_results) total += part.size();
+    result.reserve(total);
+    for (auto& part : partition_results) {
+        std::move(part.begin(), part.end(), std::back_inserter(result));
+    }
+
+    if (result.empty() && group_by_.empty()) {
+        return aggregate(RowView(), nullptr);
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CommonTypes.hpp"
+#include "Mvcc.hpp"
+#include "Row.hpp"
+#include "Value.hpp"
+
+enum class AggregateFunction {
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+    AVG,
+};
+
+std::optional<AggregateFunction> stringToAggregateFunction(const std::string& s);
+std::string aggregateFunctionToString(AggregateFunction f);
+
+struct AggregateExpr {
+    AggregateFunction function;
+    std::string column_name; // "*" only valid for COUNT(*)
+
+    std::string toString() const; // canonical form, e.g. "SUM(salary)", used as output column name
+};
+
+using GroupKey = CompositeKey;
+using GroupKeyHash = CompositeKeyHash;
+
+// running state of one aggregate inside one group
+struct Accumulator {
+    int64_t count = 0;
+    int64_t int_sum = 0;
+    double float_sum = 0.0;
+    bool has_float = false;
+    Value min;
+    Value max;
+
+    void update(const Value& v);
+    void merge(const Accumulator& other);
+    Value finalize(AggregateFunction function) const;
+};
+
+struct AggregateGroup {
+    GroupKey key;
+    std::vector<Value> values; // one per aggregate, same order as in the aggregator
+};
+
+using AggregateResult = std::vector<AggregateGroup>;
+
+class HashAggregator {
+public:
+    using RowFilter = std::function<bool(const Row&)>;
+
+    // below this many input rows spinning up workers costs more than it saves
+    static constexpr size_t PARALLEL_THRESHOLD = 1 << 15;
+    // rows handed to a worker at a time
+    static constexpr size_t MORSEL_SIZE = 1 << 14;
+    // 2^RADIX_BITS partitions for thread local tables and the merge phase
+    static constexpr int RADIX_BITS = 6;
+    static constexpr size_t PARTITION_COUNT = size_t{1} << RADIX_BITS;
+
+private:
+    using GroupTable = std::unordered_map<GroupKey, std::vector<Accumulator>, GroupKeyHash>;
+
+    std::vector<std::string> group_by_;
+    std::vector<AggregateExpr> aggregates_;
+
+    GroupKey makeKey(const Row& row) const;
+    void accumulate(std::vector<Accumulator>& accs, const Row& row) const;
+    void finalizeInto(const GroupTable& table, AggregateResult& out) const;
+    static size_t partitionOf(size_t hash);
+
+public:
+    HashAggregator(std::vector<std::string> group_by, std::vector<AggregateExpr> aggregates)
+        : group_by_(std::move(group_by)),
+          aggregates_(std::move(aggregates)) {}
+
+    AggregateResult aggregate(const RowView& rows, const RowFilter& filter = nullptr) const;
+    // thread local pre-aggregation into radix partitions, then every partition is merged by one worker
+    AggregateResult aggregateParallel(const RowView& rows, const RowFilter& filter = nullptr, size_t threads = 0) const;
+};
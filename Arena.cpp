@@ -0,0 +1,38 @@
+#include <cstdint>
+#include <new>
+
+#include "Arena.hpp"
+#include "Memory.hpp"
+
+Arena::~Arena() {
+    for (void* block : blocks_) ::operator delete(block);
+    memoryFreed(allocated());
+}
+
+// only the writer touches allocated_, no need for an atomic add
+static auto grow(std::atomic<size_t>& allocated, size_t bytes) -> void {
+    allocated.store(allocated.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    memoryAllocated(bytes);
+}
+
+auto Arena::do_allocate(size_t bytes, size_t alignment) -> void* {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(next_) % alignment) % alignment;
+    if (padding + bytes > left_) {
+        // anything bigger than a quarter block gets a block of its own, the current one stays open
+        if (bytes > BLOCK_SIZE / 4) {
+            char* block = static_cast<char*>(::operator new(bytes + alignment));
+            blocks_.push_back(block);
+            grow(allocated_, bytes + alignment);
+            return block + (alignment - reinterpret_cast<uintptr_t>(block) % alignment) % alignment;
+        }
+        next_ = static_cast<char*>(::operator new(BLOCK_SIZE));
+        blocks_.push_back(next_);
+        left_ = BLOCK_SIZE;
+        grow(allocated_, BLOCK_SIZE);
+        padding = (alignment - reinterpret_cast<uintptr_t>(next_) % alignment) % alignment;
+    }
+    void* out = next_ + padding;
+    next_ += padding + bytes;
+    left_ -= padding + bytes;
+    return out;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// bump allocator for data that dies all at once. memory comes in BLOCK_SIZE blocks, deallocate
+// does nothing and everything goes back to the heap when the arena is destroyed. not thread safe,
+// every arena has one writer (a table chunk's arena belongs to the table's writer)
+class Arena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t BLOCK_SIZE = 32 * 1024;
+
+private:
+    std::vector<void*> blocks_;
+    char* next_ = nullptr;
+    size_t left_ = 0; // bytes free at next_
+    std::atomic<size_t> allocated_ = 0; // only the writer adds, SHOW MEMORY reads it any time
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    Arena() = default;
+    ~Arena() override;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // bytes taken from the heap, counted in the process total too (see Memory.hpp)
+    size_t allocated() const { return allocated_.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,126 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Client.hpp"
+
+static auto systemError(const std::string& what) -> std::runtime_error {
+    return std::runtime_error(fmt::format("{}: {}", what, std::strerror(errno)));
+}
+
+auto Client::connectTcp(const std::string& host, uint16_t port) -> Client {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error(fmt::format("invalid IPv4 address '{}'", host));
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw systemError("socket");
+    Client client(fd);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw systemError(fmt::format("connect {}:{}", host, port));
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return client;
+}
+
+auto Client::connectUnix(const std::string& path) -> Client {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(fmt::format("socket path '{}' is too long", path));
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw systemError("socket");
+    Client client(fd);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw systemError(fmt::format("connect {}", path));
+    }
+    return client;
+}
+
+Client::Client(Client&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      input_(std::move(other.input_)),
+      input_pos_(other.input_pos_),
+      output_(std::move(other.output_)) {}
+
+auto Client::operator=(Client&& other) noexcept -> Client& {
+    if (this != &other) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+        input_ = std::move(other.input_);
+        input_pos_ = other.input_pos_;
+        output_ = std::move(other.output_);
+    }
+    return *this;
+}
+
+Client::~Client() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+auto Client::sendAll(std::string_view data) -> void {
+    while (!data.empty()) {
+        ssize_t n = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("send");
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+    }
+}
+
+auto Client::query(std::string_view statement, ResultFormat format) -> Response {
+    send(statement, format);
+    return receive();
+}
+
+auto Client::send(std::string_view statement, ResultFormat format) -> void {
+    appendRequest(output_, statement, format);
+}
+
+auto Client::flush() -> void {
+    sendAll(output_);
+    output_.clear();
+}
+
+auto Client::receive() -> Response {
+    if (!output_.empty()) flush();
+
+    char buffer[64 * 1024];
+    size_t frame_size;
+    while ((frame_size = completeFrameSize(std::string_view(input_).substr(input_pos_))) == 0) {
+        ssize_t n = ::recv(fd_, buffer, sizeof(buffer), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("recv");
+        }
+        if (n == 0) {
+            throw std::runtime_error("server closed the connection");
+        }
+        input_.append(buffer, static_cast<size_t>(n));
+    }
+
+    auto response = parseResponse(framePayload(std::string_view(input_).substr(input_pos_, frame_size)));
+    input_pos_ += frame_size;
+    if (input_pos_ == input_.size() || input_pos_ > input_.size() / 2) {
+        input_.erase(0, input_pos_); // one move for many pipelined responses
+        input_pos_ = 0;
+    }
+    return response;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Protocol.hpp"
+
+// blocking connection to a Server. query() does one round trip, send() + receive() pipeline:
+// requests are buffered until the next receive() or flush() and responses come back in order.
+// keep the number in flight bounded, the server stops reading while its responses go unread.
+// throws on connection errors
+class Client {
+private:
+    int fd_ = -1;
+    std::string input_;  // bytes read past the last response
+    size_t input_pos_ = 0; // start of the next response in input_
+    std::string output_; // requests not sent yet
+
+    explicit Client(int fd) : fd_(fd) {}
+    void sendAll(std::string_view data);
+
+public:
+    static Client connectTcp(const std::string& host, uint16_t port);
+    static Client connectUnix(const std::string& path);
+
+    Client(Client&& other) noexcept;
+    Client& operator=(Client&& other) noexcept;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+    ~Client();
+
+    // sends the statement and waits for its response
+    Response query(std::string_view statement, ResultFormat format = ResultFormat::TEXT);
+
+    void send(std::string_view statement, ResultFormat format = ResultFormat::TEXT);
+    void flush();
+    Response receive(); // flushes first, then waits for the oldest unanswered request
+};
@@ -0,0 +1,243 @@
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "Columnar.hpp"
+#include "Compression.hpp"
+
+template<typename T>
+static auto appendRaw(std::string& out, T value) -> void {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T)); // the wire is little-endian, like every host this runs on
+    out.append(bytes, sizeof(T));
+}
+
+// type every non NULL value of the column shares, STRING if they differ, NULL_VALUE if there are none
+static auto columnType(const std::vector<Value>& values) -> DataType {
+    auto type = DataType::NULL_VALUE;
+    for (const auto& value : values) {
+        if (value.isNull()) continue;
+        if (type == DataType::NULL_VALUE) {
+            type = value.getType();
+        } else if (type != value.getType()) {
+            return DataType::STRING;
+        }
+    }
+    return type;
+}
+
+auto ColumnarSink::header(const std::vector<std::string>& columns) -> void {
+    writeBatch();
+    out_ += 'H';
+    appendRaw(out_, static_cast<uint16_t>(columns.size()));
+    for (const auto& col : columns) {
+        appendRaw(out_, static_cast<uint16_t>(col.size()));
+        out_ += col;
+    }
+    columns_ = columns;
+    pending_.resize(columns.size());
+    for (auto& values : pending_) values.clear();
+}
+
+auto ColumnarSink::row(const std::vector<std::string>& columns, const Row& row) -> void {
+    for (size_t i = 0; i < columns.size() && i < pending_.size(); i++) {
+        pending_[i].push_back(row.hasColumn(columns[i]) ? row.getValue(columns[i]) : Value::Null());
+    }
+    if (++pending_rows_ == BATCH_ROWS) writeBatch();
+}
+
+auto ColumnarSink::message(std::string_view text) -> void {
+    writeBatch();
+    out_ += 'M';
+    appendRaw(out_, static_cast<uint32_t>(text.size()));
+    out_ += text;
+}
+
+auto ColumnarSink::error(std::string_view text) -> void {
+    message(text);
+}
+
+auto ColumnarSink::finish() -> void {
+    writeBatch();
+}
+
+auto ColumnarSink::clear() -> void {
+    out_.clear();
+    columns_.clear();
+    for (auto& values : pending_) values.clear();
+    pending_rows_ = 0;
+}
+
+auto ColumnarSink::writeBatch() -> void {
+    if (pending_rows_ == 0) return;
+
+    out_ += 'B';
+    appendRaw(out_, static_cast<uint32_t>(pending_rows_));
+    for (auto& values : pending_) {
+        auto type = columnType(values);
+        out_ += static_cast<char>(type);
+
+        size_t bitmap_start = out_.size();
+        out_.append((pending_rows_ + 7) / 8, '\0');
+        for (size_t r = 0; r < values.size(); r++) {
+            if (values[r].isNull()) out_[bitmap_start + r / 8] |= static_cast<char>(1 << (r % 8));
+        }
+
+        if (type == DataType::INTEGER || type == DataType::DATE || type == DataType::DATETIME) {
+            // a NULL repeats the value before it, so it doesn't break runs or deltas
+            integers_.resize(values.size());
+            int64_t last = 0;
+            for (size_t r = 0; r < values.size(); r++) {
+                const auto& v = values[r];
+                if (!v.isNull()) {
+                    if (type == DataType::INTEGER) last = v.get<int>();
+                    else if (type == DataType::DATE) last = std::chrono::sys_days(v.get<Date>()).time_since_epoch().count();
+                    else last = v.get<DateTime>().time_since_epoch().count();
+                }
+                integers_[r] = last;
+            }
+            packIntegers(integers_.data(), integers_.size(), out_);
+            values.clear();
+            continue;
+        }
+
+        switch (type) {
+            case DataType::FLOAT:
+                for (const auto& v : values) appendRaw(out_, v.isNull() ? 0.0 : v.get<double>());
+                break;
+            case DataType::BOOLEAN:
+                for (const auto& v : values) out_ += static_cast<char>(!v.isNull() && v.get<bool>());
+                break;
+            case DataType::STRING: {
+                // toString also covers a mixed column, which goes out as text
+                std::string bytes;
+                for (const auto& v : values) {
+                    if (v.isNull()) {
+                        appendRaw(out_, uint32_t{0});
+                        continue;
+                    }
+                    if (v.getType() == DataType::STRING) {
+                        auto text = v.get<std::string_view>();
+                        appendRaw(out_, static_cast<uint32_t>(text.size()));
+                        bytes += text;
+                        continue;
+                    }
+                    auto text = v.toString();
+                    appendRaw(out_, static_cast<uint32_t>(text.size()));
+                    bytes += text;
+                }
+                out_ += bytes;
+                break;
+            }
+            default:
+                break;
+        }
+        values.clear();
+    }
+    pending_rows_ = 0;
+}
+
+namespace {
+    // bounds checked reads over a response body
+    class Reader {
+    private:
+        std::string_view data_;
+        size_t pos_ = 0;
+
+    public:
+        explicit Reader(std::string_view data) : data_(data) {}
+
+        bool atEnd() const { return pos_ == data_.size(); }
+
+        std::string_view bytes(size_t n) {
+            if (data_.size() - pos_ < n) {
+                throw std::runtime_error("truncated columnar result");
+            }
+            auto out = data_.substr(pos_, n);
+            pos_ += n;
+            return out;
+        }
+
+        void integers(size_t count, int64_t* out) {
+            auto rest = data_.substr(pos_);
+            size_t before = rest.size();
+            unpackIntegers(rest, count, out);
+            pos_ += before - rest.size();
+        }
+
+        template<typename T>
+        T read() {
+            T value;
+            std::memcpy(&value, bytes(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+    };
+}
+
+auto decodeColumnar(std::string_view body) -> ColumnarResult {
+    ColumnarResult result;
+    Reader in(body);
+
+    while (!in.atEnd()) {
+        char kind = in.read<char>();
+        if (kind == 'M') {
+            auto length = in.read<uint32_t>();
+            result.messages.emplace_back(in.bytes(length));
+        } else if (kind == 'H') {
+            auto count = in.read<uint16_t>();
+            result.columns.clear();
+            result.values.assign(count, {});
+            for (uint16_t i = 0; i < count; i++) {
+                auto length = in.read<uint16_t>();
+                result.columns.emplace_back(in.bytes(length));
+            }
+        } else if (kind == 'B') {
+            auto rows = in.read<uint32_t>();
+            for (auto& values : result.values) {
+                auto type = static_cast<DataType>(in.read<uint8_t>());
+                auto nulls = in.bytes((rows + 7) / 8);
+                auto is_null = [&nulls](size_t r) { return (nulls[r / 8] >> (r % 8)) & 1; };
+
+                if (type == DataType::STRING) {
+                    std::vector<uint32_t> lengths(rows);
+                    for (auto& length : lengths) length = in.read<uint32_t>();
+                    for (size_t r = 0; r < rows; r++) {
+                        auto text = in.bytes(lengths[r]);
+                        values.push_back(is_null(r) ? Value::Null() : Value(std::string(text)));
+                    }
+                    continue;
+                }
+                if (type == DataType::INTEGER || type == DataType::DATE || type == DataType::DATETIME) {
+                    std::vector<int64_t> packed(rows);
+                    in.integers(rows, packed.data());
+                    for (size_t r = 0; r < rows; r++) {
+                        if (is_null(r)) {
+                            values.emplace_back();
+                        } else if (type == DataType::INTEGER) {
+                            values.emplace_back(static_cast<int>(packed[r]));
+                        } else if (type == DataType::DATE) {
+                            values.emplace_back(Date(std::chrono::sys_days(std::chrono::days(packed[r]))));
+                        } else {
+                            values.emplace_back(DateTime(std::chrono::milliseconds(packed[r])));
+                        }
+                    }
+                    continue;
+                }
+                for (size_t r = 0; r < rows; r++) {
+                    Value value;
+                    switch (type) {
+                        case DataType::FLOAT: value = Value(in.read<double>()); break;
+                        case DataType::BOOLEAN: value = Value(in.read<uint8_t>() != 0); break;
+                        case DataType::NULL_VALUE: break;
+                        default: throw std::runtime_error(fmt::format("unknown column type {}", static_cast<int>(type)));
+                    }
+                    values.push_back(is_null(r) ? Value::Null() : std::move(value));
+                }
+            }
+        } else {
+            throw std::runtime_error(fmt::format("unknown section '{}' in columnar result", kind));
+        }
+    }
+    return result;
+}
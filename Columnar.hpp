@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ResultSink.hpp"
+#include "Value.hpp"
+
+// binary result encoding for clients that asked for it instead of tab separated text.
+// a body is a sequence of sections, all integers little-endian:
+//   'M' u32 length, text             a message or error line
+//   'H' u16 columns, per column u16 length + name
+//   'B' u32 rows, then per column of the last header:
+//       u8 DataType, null bitmap of (rows + 7) / 8 bytes (bit set = NULL), then the values:
+//       FLOAT f64 and BOOLEAN u8 one per row with NULL rows zeroed. INTEGER, DATE (days) and
+//       DATETIME (ms since the epoch) as one packed integer block (see Compression.hpp), NULL rows
+//       repeat the value before them. STRING is u32 lengths for every row, then the bytes.
+//       a column that only holds NULLs has type NULL_VALUE and no values
+// a column whose values don't share one type within a batch is sent as STRING
+
+// encodes rows into batches of up to BATCH_ROWS
+class ColumnarSink : public ResultSink {
+public:
+    static constexpr size_t BATCH_ROWS = 1024;
+
+private:
+    std::string out_;
+    std::vector<std::string> columns_;
+    std::vector<std::vector<Value>> pending_; // per column, rows since the last batch
+    std::vector<int64_t> integers_;           // a column being packed, reused
+    size_t pending_rows_ = 0;
+
+    void writeBatch();
+
+public:
+    void header(const std::vector<std::string>& columns) override;
+    void row(const std::vector<std::string>& columns, const Row& row) override;
+    void message(std::string_view text) override;
+    void error(std::string_view text) override;
+    void finish() override;
+
+    const std::string& data() const { return out_; }
+    void clear(); // keeps the capacity for the next statement
+};
+
+struct ColumnarResult {
+    std::vector<std::string> columns;
+    std::vector<std::vector<Value>> values; // per column, all batches appended
+    std::vector<std::string> messages;      // messages and errors in the order they came
+
+    size_t rowCount() const { return values.empty() ? 0 : values[0].size(); }
+};
+
+// throws on a truncated or malformed body
+ColumnarResult decodeColumnar(std::string_view body);
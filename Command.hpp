@@ -14,6 +14,11 @@ enum class CommandType {
     LOAD,
     SHOW,
     HELP,
+    PREPARE,
+    EXECUTE,
+    BEGIN,
+    COMMIT,
+    ROLLBACK,
     UNKNOWN
 };
 
@@ -103,6 +103,10 @@ auto InsertCommand::getValues() const -> const std::vector<std::vector<Value>>&
     return values_;
 }
 
+auto InsertCommand::setValue(size_t row, size_t column, Value value) -> void {
+    values_.at(row).at(column) = std::move(value);
+}
+
 auto InsertCommand::toString() const -> std::string {
     std::string result = fmt::format("INSERT INTO {}", table_name_);
 
@@ -135,6 +139,10 @@ auto UpdateCommand::getColumnValues() const -> const std::unordered_map<std::str
     return column_values_;
 }
 
+auto UpdateCommand::setColumnValue(const std::string& column, Value value) -> void {
+    column_values_[column] = std::move(value);
+}
+
 auto UpdateCommand::getWhereClause() const -> const std::string& {
     return where_clause_;
 }
@@ -182,6 +190,30 @@ auto SelectCommand::getWhereClause() const -> const std::string& {
     return where_clause_;
 }
 
+auto SelectCommand::getGroupBy() const -> const std::vector<std::string>& {
+    return group_by_;
+}
+
+auto SelectCommand::getAggregates() const -> const std::vector<AggregateExpr>& {
+    return aggregates_;
+}
+
+auto SelectCommand::isAggregate() const -> bool {
+    return !aggregates_.empty() || !group_by_.empty();
+}
+
+auto SelectCommand::getOrderBy() const -> const std::vector<OrderByItem>& {
+    return order_by_;
+}
+
+auto SelectCommand::getLimit() const -> std::optional<size_t> {
+    return limit_;
+}
+
+auto SelectCommand::getOffset() const -> size_t {
+    return offset_;
+}
+
 auto SelectCommand::toString() const -> std::string {
     std::string column_part = column_names_.empty()
         ? "*"
@@ -194,6 +226,22 @@ auto SelectCommand::toString() const -> std::string {
     if (!where_clause_.empty()) {
         result += fmt::format(" WHERE {}", where_clause_);
     }
+    if (!group_by_.empty()) {
+        result += fmt::format(" GROUP BY {}", fmt::join(group_by_, ", "));
+    }
+    if (!order_by_.empty()) {
+        std::vector<std::string> items;
+        for (const auto& item : order_by_) {
+            items.push_back(item.toString());
+        }
+        result += fmt::format(" ORDER BY {}", fmt::join(items, ", "));
+    }
+    if (limit_) {
+        result += fmt::format(" LIMIT {}", *limit_);
+    }
+    if (offset_ > 0) {
+        result += fmt::format(" OFFSET {}", offset_);
+    }
     return result;
 }
 
@@ -227,11 +275,52 @@ auto ShowCommand::toString() const -> std::string {
             return "SHOW TABLES";
         case ShowType::COLUMNS:
             return fmt::format("SHOW COLUMNS FROM {}", table_name_);
+        case ShowType::MEMORY:
+            return table_name_.empty() ? "SHOW MEMORY" : fmt::format("SHOW MEMORY {}", table_name_);
         default:
             throw std::runtime_error("unknown SHOW command");
     }
 }
 
+auto PrepareCommand::getName() const -> const std::string& {
+    return name_;
+}
+
+auto PrepareCommand::getStatement() const -> const std::string& {
+    return statement_;
+}
+
+auto PrepareCommand::toString() const -> std::string {
+    return fmt::format("PREPARE {} AS {}", name_, statement_);
+}
+
+auto ExecuteCommand::getName() const -> const std::string& {
+    return name_;
+}
+
+auto ExecuteCommand::getParameters() const -> const std::vector<Value>& {
+    return parameters_;
+}
+
+auto ExecuteCommand::toString() const -> std::string {
+    std::vector<std::string> params;
+    for (const auto& param : parameters_) {
+        params.push_back(param.getType() == DataType::STRING ? fmt::format("'{}'", param.toString()) : param.toString());
+    }
+    return fmt::format("EXECUTE {}({})", name_, fmt::join(params, ", "));
+}
+
+auto TransactionCommand::toString() const -> std::string {
+    switch (getType()) {
+        case CommandType::BEGIN:
+            return "BEGIN";
+        case CommandType::COMMIT:
+            return "COMMIT";
+        default:
+            return "ROLLBACK";
+    }
+}
+
 auto HelpCommand::toString() const -> std::string {
     if (hasSpecificCommand()) {
         return fmt::format("HELP {}", command_name_);
@@ -2,11 +2,14 @@
 
 #include <vector>
 #include <string>
+#include <optional>
 
 #include "Command.hpp"
 #include "CommonTypes.hpp"
 #include "Column.hpp"
 #include "Value.hpp"
+#include "Aggregate.hpp"
+#include "Sort.hpp"
 
 /*
     *
@@ -128,6 +131,7 @@ public:
     const std::string& getTableName() const;
     const std::vector<std::string>& getColumnNames() const;
     const std::vector<std::vector<Value>>& getValues() const;
+    void setValue(size_t row, size_t column, Value value); // binds a prepared statement parameter
 
     std::string toString() const override;
 };
@@ -150,6 +154,7 @@ public:
 
     const std::string& getTableName() const;
     const std::unordered_map<std::string, Value>& getColumnValues() const;
+    void setColumnValue(const std::string& column, Value value); // binds a prepared statement parameter
     const std::string& getWhereClause() const;
 
     std::string toString() const override;
@@ -182,22 +187,43 @@ public:
 */
 class SelectCommand : public Command {
 private:
-    std::vector<std::string> column_names_;
+    std::vector<std::string> column_names_; // aggregates appear here in their canonical form, e.g. "SUM(salary)"
     std::vector<std::string> table_names_;
     std::string where_clause_;
+    std::vector<std::string> group_by_;
+    std::vector<AggregateExpr> aggregates_;
+    std::vector<OrderByItem> order_by_;
+    std::optional<size_t> limit_;
+    size_t offset_;
 
 public:
     SelectCommand(std::vector<std::string> column_names, 
                   std::vector<std::string> table_names,
-                  std::string where_clause = "")
+                  std::string where_clause = "",
+                  std::vector<std::string> group_by = {},
+                  std::vector<AggregateExpr> aggregates = {},
+                  std::vector<OrderByItem> order_by = {},
+                  std::optional<size_t> limit = std::nullopt,
+                  size_t offset = 0)
         : Command(CommandType::SELECT),
           column_names_(std::move(column_names)),
           table_names_(std::move(table_names)),
-          where_clause_(std::move(where_clause)) {}
+          where_clause_(std::move(where_clause)),
+          group_by_(std::move(group_by)),
+          aggregates_(std::move(aggregates)),
+          order_by_(std::move(order_by)),
+          limit_(limit),
+          offset_(offset) {}
 
     const std::vector<std::string>& getColumnNames() const;
     const std::vector<std::string>& getTableNames() const;
     const std::string& getWhereClause() const;
+    const std::vector<std::string>& getGroupBy() const;
+    const std::vector<AggregateExpr>& getAggregates() const;
+    bool isAggregate() const;
+    const std::vector<OrderByItem>& getOrderBy() const;
+    std::optional<size_t> getLimit() const;
+    size_t getOffset() const;
 
     std::string toString() const override;
 };
@@ -237,7 +263,8 @@ class ShowCommand : public Command {
 public:
     enum class ShowType {
         TABLES,
-        COLUMNS
+        COLUMNS,
+        MEMORY // of every table, or of the columns of one
     };
 
 private:
@@ -251,11 +278,67 @@ public:
           show_type_(ShowType::COLUMNS),
           table_name_(std::move(table_name)) {}
 
+    ShowCommand(ShowType show_type, std::string table_name) : Command(CommandType::SHOW),
+          show_type_(show_type),
+          table_name_(std::move(table_name)) {}
+
     ShowType getShowType() const;
     const std::string& getTableName() const;
     std::string toString() const override;
 };
 
+/*
+    *
+    *
+    *  ===== Prepared statements =====
+    *
+    *
+*/
+class PrepareCommand : public Command {
+private:
+    std::string name_;
+    std::string statement_; // SQL text with $1, $2... placeholders
+
+public:
+    PrepareCommand(std::string name, std::string statement) : Command(CommandType::PREPARE),
+        name_(std::move(name)),
+        statement_(std::move(statement)) {}
+
+    const std::string& getName() const;
+    const std::string& getStatement() const;
+    std::string toString() const override;
+};
+
+class ExecuteCommand : public Command {
+private:
+    std::string name_;
+    std::vector<Value> parameters_;
+
+public:
+    ExecuteCommand(std::string name, std::vector<Value> parameters) : Command(CommandType::EXECUTE),
+        name_(std::move(name)),
+        parameters_(std::move(parameters)) {}
+
+    const std::string& getName() const;
+    const std::vector<Value>& getParameters() const;
+    std::string toString() const override;
+};
+
+/*
+    *
+    *
+    *  ===== Transactions =====
+    *
+    *
+*/
+// BEGIN, COMMIT or ROLLBACK, the command type says which
+class TransactionCommand : public Command {
+public:
+    explicit TransactionCommand(CommandType type) : Command(type) {}
+
+    std::string toString() const override;
+};
+
 /*
     *
     *
@@ -3,6 +3,8 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <memory_resource>
+#include <string>
 
 // forwards
 class Constraint;
@@ -28,4 +30,5 @@ using ColumnMap = std::unordered_map<std::string, Column>;
 using TableMap = std::unordered_map<std::string, Table>;
 using TablePtrMap = std::unordered_map<std::string, TablePtr>;
 using DatabaseMap = std::unordered_map<std::string, Database>;
-using ValueMap = std::unordered_map<std::string, Value>;
+// pmr so a table can keep its rows in an arena (see Arena.hpp), copies go to the default heap
+using ValueMap = std::pmr::unordered_map<std::string, Value>;
@@ -0,0 +1,66 @@
+#include <array>
+#include <stdexcept>
+
+#include "Compare.hpp"
+
+auto compareValues(const Value& lhs, CompareOp op, const Value& rhs) -> bool {
+    switch (op) {
+        case CompareOp::EQ: return lhs == rhs;
+        case CompareOp::NE: return lhs != rhs;
+        case CompareOp::LT: return lhs < rhs;
+        case CompareOp::GT: return lhs > rhs;
+        case CompareOp::LE: return lhs <= rhs;
+        case CompareOp::GE: return lhs >= rhs;
+        case CompareOp::IS_NULL: return lhs.isNull();
+        case CompareOp::IS_NOT_NULL: return !lhs.isNull();
+        case CompareOp::IN: break;
+    }
+    throw std::runtime_error("unknown compare operator");
+}
+
+auto compareOrder(const Value& lhs, const Value& rhs) -> int {
+    if (lhs.isNull() || rhs.isNull()) {
+        return lhs.isNull() == rhs.isNull() ? 0 : (lhs.isNull() ? -1 : 1);
+    }
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+// one row of kernels per type, in DataType order, one column per CompareOp up to GE
+template<DataType Type>
+static constexpr std::array<CompareKernel, 6> kernelsOf() {
+    return {
+        typedCompare<Type, CompareOp::EQ>, typedCompare<Type, CompareOp::NE>,
+        typedCompare<Type, CompareOp::LT>, typedCompare<Type, CompareOp::GT>,
+        typedCompare<Type, CompareOp::LE>, typedCompare<Type, CompareOp::GE>,
+    };
+}
+
+static constexpr std::array<std::array<CompareKernel, 6>, 6> compare_kernels = {
+    kernelsOf<DataType::INTEGER>(),
+    kernelsOf<DataType::FLOAT>(),
+    kernelsOf<DataType::BOOLEAN>(),
+    kernelsOf<DataType::STRING>(),
+    kernelsOf<DataType::DATE>(),
+    kernelsOf<DataType::DATETIME>(),
+};
+
+static constexpr std::array<OrderKernel, 6> order_kernels = {
+    typedOrder<DataType::INTEGER>,
+    typedOrder<DataType::FLOAT>,
+    typedOrder<DataType::BOOLEAN>,
+    typedOrder<DataType::STRING>,
+    typedOrder<DataType::DATE>,
+    typedOrder<DataType::DATETIME>,
+};
+
+auto compareKernel(DataType type, CompareOp op) -> CompareKernel {
+    auto t = static_cast<size_t>(type);
+    auto o = static_cast<size_t>(op);
+    if (t >= compare_kernels.size() || o >= compare_kernels[t].size()) return nullptr;
+    return compare_kernels[t][o];
+}
+
+auto orderKernel(DataType type) -> OrderKernel {
+    auto t = static_cast<size_t>(type);
+    return t < order_kernels.size() ? order_kernels[t] : compareOrder;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string_view>
+
+#include "Value.hpp"
+
+enum class CompareOp {
+    EQ,
+    NE,
+    LT,
+    GT,
+    LE,
+    GE,
+    IN, // only in a Condition, against its list
+    IS_NULL, // no rhs
+    IS_NOT_NULL,
+};
+
+// lhs op rhs for any two values: different types are unequal, ordering them throws
+bool compareValues(const Value& lhs, CompareOp op, const Value& rhs);
+// -1, 0 or 1 in ORDER BY order, NULLs first. throws on two values of different types
+int compareOrder(const Value& lhs, const Value& rhs);
+
+// comparisons resolved once per column type when a statement binds to its table, instead of
+// switching on the types of every pair of values. a kernel checks that both values really have
+// its type (nothing stops an INSERT from storing another) and hands anything else, NULLs
+// included, to the generic functions above, so results are the same either way
+using CompareKernel = bool (*)(const Value& lhs, const Value& rhs);
+using OrderKernel = int (*)(const Value& lhs, const Value& rhs);
+
+CompareKernel compareKernel(DataType type, CompareOp op); // nullptr for IN, IS [NOT] NULL and NULL_VALUE
+OrderKernel orderKernel(DataType type);                   // compareOrder for NULL_VALUE
+
+// the C++ type a kernel reads values of Type as
+template<DataType Type> struct NativeType;
+template<> struct NativeType<DataType::INTEGER> { using type = int; };
+template<> struct NativeType<DataType::FLOAT> { using type = double; };
+template<> struct NativeType<DataType::BOOLEAN> { using type = bool; };
+template<> struct NativeType<DataType::STRING> { using type = std::string_view; };
+template<> struct NativeType<DataType::DATE> { using type = Date; };
+template<> struct NativeType<DataType::DATETIME> { using type = DateTime; };
+
+template<DataType Type, CompareOp Op>
+bool typedCompare(const Value& lhs, const Value& rhs) {
+    if (lhs.getType() != Type || rhs.getType() != Type) [[unlikely]] {
+        return compareValues(lhs, Op, rhs);
+    }
+    if constexpr (Type == DataType::STRING && (Op == CompareOp::EQ || Op == CompareOp::NE)) {
+        return (lhs == rhs) == (Op == CompareOp::EQ); // dictionary codes, see Value::operator==
+    } else {
+        using T = typename NativeType<Type>::type;
+        T a = lhs.getUnchecked<T>();
+        T b = rhs.getUnchecked<T>();
+        if constexpr (Op == CompareOp::EQ) return a == b;
+        else if constexpr (Op == CompareOp::NE) return a != b;
+        else if constexpr (Op == CompareOp::LT) return a < b;
+        else if constexpr (Op == CompareOp::GT) return b < a;
+        else if constexpr (Op == CompareOp::LE) return !(b < a);
+        else return !(a < b);
+    }
+}
+
+template<DataType Type>
+int typedOrder(const Value& lhs, const Value& rhs) {
+    if (lhs.getType() != Type || rhs.getType() != Type) [[unlikely]] {
+        return compareOrder(lhs, rhs);
+    }
+    using T = typename NativeType<Type>::type;
+    T a = lhs.getUnchecked<T>();
+    T b = rhs.getUnchecked<T>();
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
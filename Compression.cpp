@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Compression.hpp"
+
+// subtraction is done on uint64_t so the range of any two int64_t fits
+
+static auto bitWidth(uint64_t range) -> uint8_t {
+    uint8_t width = 0;
+    while (width < 64 && (range >> width) != 0) width++;
+    return width;
+}
+
+static auto packedWords(size_t count, uint8_t width) -> size_t {
+    return (count * width + 63) / 64;
+}
+
+// bytes a FOR block of these values takes
+static auto forSize(const int64_t* values, size_t count) -> size_t {
+    if (count == 0) return 1 + 8 + 1;
+    int64_t lo = values[0], hi = values[0];
+    for (size_t i = 1; i < count; i++) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    return 1 + 8 + 1 + 8 * packedWords(count, bitWidth(static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo)));
+}
+
+template<typename T>
+static auto appendRaw(std::string& out, T value) -> void {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template<typename T>
+static auto readRaw(std::string_view& in) -> T {
+    if (in.size() < sizeof(T)) {
+        throw std::runtime_error("truncated integer block");
+    }
+    T value;
+    std::memcpy(&value, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return value;
+}
+
+// base, width and the packed words, without the scheme byte
+static auto packFor(const int64_t* values, size_t count, std::string& out) -> void {
+    int64_t lo = count ? values[0] : 0, hi = lo;
+    for (size_t i = 1; i < count; i++) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    uint8_t width = bitWidth(static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo));
+    appendRaw(out, lo);
+    appendRaw(out, width);
+    if (width == 0) return;
+
+    std::vector<uint64_t> words(packedWords(count, width));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(lo);
+        size_t bit = i * width;
+        size_t word = bit / 64, shift = bit % 64;
+        words[word] |= v << shift;
+        if (shift + width > 64) words[word + 1] |= v >> (64 - shift);
+    }
+    out.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+}
+
+static auto unpackFor(std::string_view& in, size_t count, int64_t* out) -> void {
+    auto base = static_cast<uint64_t>(readRaw<int64_t>(in));
+    auto width = readRaw<uint8_t>(in);
+    if (width > 64) {
+        throw std::runtime_error(fmt::format("bad bit width {} in integer block", width));
+    }
+    if (width == 0) {
+        for (size_t i = 0; i < count; i++) out[i] = static_cast<int64_t>(base);
+        return;
+    }
+
+    size_t bytes = packedWords(count, width) * sizeof(uint64_t);
+    if (in.size() < bytes) {
+        throw std::runtime_error("truncated integer block");
+    }
+    std::vector<uint64_t> words(bytes / sizeof(uint64_t));
+    std::memcpy(words.data(), in.data(), bytes);
+    in.remove_prefix(bytes);
+
+    // no branches on the value, the compiler keeps this loop tight
+    uint64_t mask = width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * width;
+        size_t word = bit / 64, shift = bit % 64;
+        uint64_t v = words[word] >> shift;
+        if (shift + width > 64) v |= words[word + 1] << (64 - shift);
+        out[i] = static_cast<int64_t>((v & mask) + base);
+    }
+}
+
+auto packIntegers(const int64_t* values, size_t count, std::string& out) -> void {
+    std::vector<int64_t> deltas(count > 0 ? count - 1 : 0);
+    for (size_t i = 1; i < count; i++) {
+        deltas[i - 1] = static_cast<int64_t>(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(values[i - 1]));
+    }
+    std::vector<int64_t> run_values, run_lengths;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && values[i] == run_values.back()) {
+            run_lengths.back()++;
+        } else {
+            run_values.push_back(values[i]);
+            run_lengths.push_back(1);
+        }
+    }
+
+    size_t for_size = forSize(values, count);
+    size_t delta_size = 8 + forSize(deltas.data(), deltas.size());
+    size_t rle_size = 4 + forSize(run_values.data(), run_values.size()) + forSize(run_lengths.data(), run_lengths.size());
+
+    if (rle_size < for_size && rle_size <= delta_size) {
+        appendRaw(out, PackScheme::RLE);
+        appendRaw(out, static_cast<uint32_t>(run_values.size()));
+        packFor(run_values.data(), run_values.size(), out);
+        packFor(run_lengths.data(), run_lengths.size(), out);
+    } else if (delta_size < for_size) {
+        appendRaw(out, PackScheme::DELTA);
+        appendRaw(out, values[0]);
+        packFor(deltas.data(), deltas.size(), out);
+    } else {
+        appendRaw(out, PackScheme::FOR);
+        packFor(values, count, out);
+    }
+}
+
+auto unpackIntegers(std::string_view& in, size_t count, int64_t* out) -> void {
+    auto scheme = readRaw<PackScheme>(in);
+    switch (scheme) {
+        case PackScheme::FOR:
+            unpackFor(in, count, out);
+            return;
+        case PackScheme::DELTA: {
+            auto first = readRaw<int64_t>(in);
+            if (count == 0) {
+                throw std::runtime_error("empty DELTA integer block");
+            }
+            out[0] = first;
+            unpackFor(in, count - 1, out + 1);
+            for (size_t i = 1; i < count; i++) {
+                out[i] = static_cast<int64_t>(static_cast<uint64_t>(out[i]) + static_cast<uint64_t>(out[i - 1]));
+            }
+            return;
+        }
+        case PackScheme::RLE: {
+            auto runs = readRaw<uint32_t>(in);
+            if (runs > count) {
+                throw std::runtime_error("more runs than values in integer block");
+            }
+            std::vector<int64_t> values(runs), lengths(runs);
+            unpackFor(in, runs, values.data());
+            unpackFor(in, runs, lengths.data());
+            size_t at = 0;
+            for (size_t r = 0; r < runs; r++) {
+                if (lengths[r] < 0 || static_cast<size_t>(lengths[r]) > count - at) {
+                    throw std::runtime_error("run past the end of integer block");
+                }
+                std::fill(out + at, out + at + lengths[r], values[r]);
+                at += lengths[r];
+            }
+            if (at != count) {
+                throw std::runtime_error("runs don't cover integer block");
+            }
+            return;
+        }
+    }
+    throw std::runtime_error(fmt::format("unknown integer block scheme {}", static_cast<int>(scheme)));
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// lightweight compression of a block of integers, picked per block by whichever comes out smallest:
+//   FOR   frame of reference: i64 base, u8 bit width, then every value - base bit-packed
+//   DELTA i64 first value, then the differences between neighbours as a FOR block
+//   RLE   u32 runs, then the run values and the run lengths as two FOR blocks
+// a block starts with its u8 Scheme. bit-packed values are LSB first in little-endian u64 words.
+// sorted columns (timestamps, ids) pack as DELTA, low cardinality runs as RLE, the rest as FOR
+enum class PackScheme : uint8_t {
+    FOR = 0,
+    DELTA = 1,
+    RLE = 2,
+};
+
+void packIntegers(const int64_t* values, size_t count, std::string& out);
+// reads a block of count values written by packIntegers from the front of in and drops it from
+// in. throws on a truncated or malformed block
+void unpackIntegers(std::string_view& in, size_t count, int64_t* out);
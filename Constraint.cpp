@@ -49,7 +49,7 @@ auto PrimaryKeyConstraint::validate(const Row& row, const Table& table) const ->
         }
     }
 
-    for (const auto& existing_row : table.getRows()) {
+    for (const auto& existing_row : table.rows()) {
         bool matches = true;
         for (const auto& col_name : column_names) {
             if (!existing_row.hasColumn(col_name) || 
@@ -85,7 +85,7 @@ auto ForeignKeyConstraint::validate(const Row& row, const Table& table, const Da
     if (value.isNull()) return true; // allow nulls
 
     // check if value exists
-    for (const auto& ref_row : ref_table_obj->getRows()) {
+    for (const auto& ref_row : ref_table_obj->rows()) {
         if (ref_row.hasColumn(ref_column) && (ref_row.getValue(ref_column) == value)) {
             return true;
         }
@@ -127,7 +127,7 @@ auto UniqueConstraint::validate(const Row& row, const Table& table) const -> boo
         }
     }
 
-    for (const auto& existing_row : table.getRows()) {
+    for (const auto& existing_row : table.rows()) {
         bool matches = true;
 
         for (const auto& col_name : column_names) {
@@ -81,4 +81,21 @@ auto Database::validateRow(const std::string& table_name, const Row& row) -> boo
 
 auto Database::clear() -> void {
     tables_.clear();
+    schemaChanged();
+}
+
+auto Database::getSchemaVersion() const -> uint64_t {
+    return schema_version_;
+}
+
+auto Database::schemaChanged() -> void {
+    schema_version_++;
+}
+
+auto Database::catalogLatch() const -> std::shared_mutex& {
+    return catalog_latch_;
+}
+
+auto Database::getClock() -> VersionClock& {
+    return clock_;
 }
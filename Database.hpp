@@ -1,14 +1,23 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
 #include <string>
 
 #include "CommonTypes.hpp"
+#include "Mvcc.hpp"
 
 class Database {
 private: 
     std::string name_;
     TablePtrMap tables_;
+    std::atomic<uint64_t> schema_version_ = 0;
+    // guards tables_ and every table's columns and constraints, exclusive for DDL (see Latch.hpp).
+    // the methods below don't take it, with several sessions running the caller holds it
+    mutable std::shared_mutex catalog_latch_;
+    VersionClock clock_;
 public:
     Database(std::string name) : name_(name) {
         if (name_.empty()) {
@@ -35,6 +44,14 @@ public:
     bool validateRow(const std::string& table_name, const Row& row);
 
     void clear();
+
+    // bumped by every CREATE, DROP, ALTER and LOAD, cached plans from an older version are stale
+    uint64_t getSchemaVersion() const;
+    void schemaChanged();
+
+    std::shared_mutex& catalogLatch() const;
+    // commit timestamps of every table and the snapshots reading them
+    VersionClock& getClock();
 };
 
 #endif //DATABASE_H
@@ -0,0 +1,76 @@
+#include <functional>
+#include <mutex>
+
+#include "Dictionary.hpp"
+
+std::atomic<uint32_t> StringDictionary::next_id_{0};
+
+auto StringDictionary::encode(const Value& value) -> Value {
+    if (value.getType() != DataType::STRING) return value;
+    if (value.isCoded() && value.dictionary() == id_) return value;
+
+    std::unique_lock lock(mutex_);
+    if (plain_) return value;
+    auto text = value.get<std::string_view>();
+    auto it = codes_.find(text);
+    if (it != codes_.end()) return values_[it->second];
+
+    if (values_.size() == MAX_CODES) {
+        // too many distinct values to be worth it, rows already coded keep their strings
+        plain_ = true;
+        codes_ = {};
+        values_ = {};
+        payload_ = 0;
+        memory_.release();
+        return value;
+    }
+
+    auto code = static_cast<uint16_t>(values_.size());
+    Value::HeapString* string = Value::HeapString::make(text);
+    string->hash = std::hash<std::string_view>{}(text);
+    Value coded;
+    coded.type_ = DataType::STRING;
+    coded.size_ = Value::CODED;
+    std::memcpy(coded.payload_, &string, sizeof(string));
+    std::memcpy(coded.payload_ + Value::CODE_OFFSET, &code, sizeof(code));
+    std::memcpy(coded.payload_ + Value::DICTIONARY_OFFSET, &id_, sizeof(id_));
+    values_.push_back(coded);
+    codes_.emplace(std::string_view(string->data(), string->size), code);
+    payload_ += text.size();
+    charge();
+    return coded;
+}
+
+auto StringDictionary::lookup(const Value& value) const -> Value {
+    if (value.getType() != DataType::STRING || value.isCoded()) return value;
+    std::shared_lock lock(mutex_);
+    auto it = codes_.find(value.get<std::string_view>());
+    return it != codes_.end() ? values_[it->second] : value;
+}
+
+auto StringDictionary::isPlain() const -> bool {
+    std::shared_lock lock(mutex_);
+    return plain_;
+}
+
+auto StringDictionary::size() const -> size_t {
+    std::shared_lock lock(mutex_);
+    return values_.size();
+}
+
+// under the exclusive lock, after a string was added
+auto StringDictionary::charge() -> void {
+    constexpr size_t NODE = sizeof(void*) + sizeof(size_t) + sizeof(std::pair<const std::string_view, uint16_t>);
+    memory_.set(values_.size() * sizeof(Value::HeapString) + payload_ + values_.capacity() * sizeof(Value) +
+                codes_.size() * NODE + codes_.bucket_count() * sizeof(void*));
+}
+
+auto StringDictionary::allocated() const -> size_t {
+    std::shared_lock lock(mutex_);
+    return memory_.bytes();
+}
+
+auto StringDictionary::payload() const -> size_t {
+    std::shared_lock lock(mutex_);
+    return payload_;
+}
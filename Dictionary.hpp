@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Memory.hpp"
+#include "Value.hpp"
+
+// dictionary encoding of one STRING column. every distinct string is stored once and gets a code
+// in first seen order, rows hold coded values pointing at it (see Value.hpp), so equality, IN
+// and GROUP BY compare codes and hash a cached hash instead of the characters.
+// past MAX_CODES distinct strings the column falls back to plain storage: new strings are
+// stored as they come, the coded ones already in rows keep their strings alive and stay valid
+class StringDictionary {
+public:
+    static constexpr size_t MAX_CODES = size_t{1} << 16;
+
+private:
+    static std::atomic<uint32_t> next_id_;
+
+    uint32_t id_;
+    // written by the writer of the table, read by statements translating their literals
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string_view, uint16_t> codes_; // views into the strings in values_
+    std::vector<Value> values_;                            // by code
+    bool plain_ = false;
+    size_t payload_ = 0;  // characters of the strings in values_
+    MemoryCharge memory_; // the strings, codes_ and values_
+
+    void charge();
+
+public:
+    StringDictionary() : id_(next_id_.fetch_add(1, std::memory_order_relaxed)) {}
+    StringDictionary(const StringDictionary&) = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+
+    // the coded form of value, added to the dictionary if it is new. anything that isn't a
+    // string, and every string once the column fell back, comes back unchanged
+    Value encode(const Value& value);
+    // the coded form of value if it is in the dictionary, value itself otherwise
+    Value lookup(const Value& value) const;
+    // true once the column fell back. until then a string that lookup() didn't find is in no row
+    bool isPlain() const;
+    size_t size() const; // distinct strings
+    // bytes the strings and their lookup take, and the characters alone. a column that fell
+    // back has none, its strings are in the rows
+    size_t allocated() const;
+    size_t payload() const;
+};
@@ -2,153 +2,775 @@
 #include <fmt/base.h>
 #include <fmt/ostream.h>
 #include <fmt/format.h>
+#include <bit>
 #include <fstream>
 #include <map>
+#include <optional>
 #include <sstream>
+#include <utility>
 
 #include "Executor.hpp"
 #include "Table.hpp"
 #include "Parser.hpp"
+#include "Aggregate.hpp"
+#include "Join.hpp"
+#include "Memory.hpp"
+#include "Predicate.hpp"
+#include "Sort.hpp"
 #include "data_types.hpp"
 
-bool Executor::evaluateWhereCondition(const Row& row, const std::string& where_clause) {
-    if (where_clause.empty()) {
-        return true; // No WHERE clause means condition is satisfied
+auto Executor::execute(const std::unique_ptr<Command>& command) -> bool {
+    if (!command) {
+        sink_.error("err: null command recieved");
+        return false;
     }
+    return execute(*command, nullptr);
+}
 
-    // Parse the WHERE clause
-    std::string column_name, operator_str, value_str;
-    std::istringstream iss(where_clause);
-    iss >> column_name >> operator_str >> value_str;
+static auto chooseAccessPath(const SelectCommand& c) -> AccessPath {
+    if (c.getTableNames().size() > 1) return AccessPath::JOIN;
+    if (c.isAggregate()) return AccessPath::AGGREGATE;
+    if (c.getOrderBy().empty()) return AccessPath::SCAN;
+    return c.getLimit() ? AccessPath::TOP_K : AccessPath::SORT;
+}
 
-    if (column_name.empty() || operator_str.empty() || value_str.empty()) {
-        throw std::runtime_error("invalid WHERE clause format");
+// * is left alone if a table is missing, executing the statement reports that
+static auto expandStar(const SelectCommand& c, const Database& database) -> std::vector<std::string> {
+    const auto& columns = c.getColumnNames();
+    if (columns.size() != 1 || columns[0] != "*") return columns;
+
+    const auto& table_names = c.getTableNames();
+    std::vector<std::string> expanded;
+    for (const auto& table_name : table_names) {
+        auto table = database.getTable(table_name);
+        if (!table) return columns;
+        for (const auto& col : table->getColumns()) {
+            // joins get qualified names, bare ones could be ambiguous
+            expanded.push_back(table_names.size() > 1 ? fmt::format("{}.{}", table_name, col.getName()) : col.getName());
+        }
     }
-    
-    if (!row.hasColumn(column_name)) {
-        return false; // Column doesn't exist in this row
+    return expanded;
+}
+
+auto Executor::plan(const Command& command, const Database& database) -> Plan {
+    switch (command.getType()) {
+        case CommandType::SELECT: {
+            const auto& c = static_cast<const SelectCommand&>(command);
+            return Plan{Predicate::parse(c.getWhereClause()), chooseAccessPath(c), expandStar(c, database)};
+        }
+        case CommandType::INSERT: {
+            // no column list means all of the table's columns in order
+            const auto& c = static_cast<const InsertCommand&>(command);
+            Plan plan{Predicate(), AccessPath::SCAN, c.getColumnNames()};
+            auto table = database.getTable(c.getTableName());
+            if (plan.columns.empty() && table) {
+                for (const auto& col : table->getColumns()) {
+                    plan.columns.push_back(col.getName());
+                }
+            }
+            return plan;
+        }
+        case CommandType::UPDATE:
+            return Plan{Predicate::parse(static_cast<const UpdateCommand&>(command).getWhereClause()), AccessPath::SCAN, {}};
+        case CommandType::DELETE:
+            return Plan{Predicate::parse(static_cast<const DeleteCommand&>(command).getWhereClause()), AccessPath::SCAN, {}};
+        default:
+            return Plan();
+    }
+}
+
+// what a statement reads at. writers see the newest rows, uncommitted ones of their own included,
+// their latches keep everyone else's writes out of the table. readers get a snapshot
+static auto readsNewest(CommandType type) -> bool {
+    return type == CommandType::INSERT || type == CommandType::UPDATE || type == CommandType::DELETE;
+}
+
+auto Executor::execute(const Command& command, const Plan* plan) -> bool {
+    // LOAD executes statements from inside itself, each of them is a statement of its own
+    std::optional<Snapshot> snapshot;
+    if (readsNewest(command.getType())) {
+        snapshot.emplace();
+    } else {
+        snapshot.emplace(database_.getClock());
     }
+    std::vector<Written> written;
+    auto outer_snapshot = std::exchange(snapshot_, &*snapshot);
+    auto outer_written = std::exchange(written_, &written);
 
-    // Get the actual value from the row
-    const auto& value = row.getValue(column_name);
-    Value compare_value;
-    
-    // Parse the comparison value
-    try {
-        if (value_str.front() == '\'' || value_str.front() == '"') {
-            compare_value = Value(value_str.substr(1, value_str.length()-2));
-        } else if (value_str == "true" || value_str == "false") {
-            compare_value = Value(value_str == "true");
-        } else if (value_str.find('.') != std::string::npos) {
-            compare_value = Value(std::stod(value_str));
-        } else {
-            compare_value = Value(std::stoi(value_str));
+    bool success = run(command, plan);
+
+    if (!success) {
+        // a statement applies completely or not at all, also inside a transaction
+        uint64_t committed = database_.getClock().committed();
+        for (auto it = written.rbegin(); it != written.rend(); ++it) {
+            it->table->rollback(it->savepoint, committed);
         }
-    } catch (const std::exception& e) {
-        throw std::runtime_error(fmt::format("error parsing value in WHERE clause: {}", e.what()));
+    } else if (in_transaction_) {
+        for (const auto& [table, savepoint] : written) {
+            if (std::find(transaction_tables_.begin(), transaction_tables_.end(), table) == transaction_tables_.end()) {
+                transaction_tables_.push_back(table);
+            }
+        }
+    } else if (!written.empty()) {
+        std::vector<TablePtr> tables;
+        for (const auto& [table, savepoint] : written) tables.push_back(table);
+        commit(tables);
     }
+    snapshot_ = outer_snapshot;
+    written_ = outer_written;
+    if (!outer_snapshot) sink_.finish(); // not in the middle of a LOAD
+    return success;
+}
 
-    // Apply the comparison
-    if (operator_str == "=") return value == compare_value;
-    else if (operator_str == "!=") return value != compare_value;
-    else if (operator_str == "<") return value < compare_value;
-    else if (operator_str == ">") return value > compare_value;
-    else if (operator_str == "<=") return value <= compare_value;
-    else if (operator_str == ">=") return value >= compare_value;
-    else throw std::runtime_error(fmt::format("unsupported operator in WHERE clause: {}", operator_str));
+// the writes to tables become visible all at once
+auto Executor::commit(const std::vector<TablePtr>& tables) -> void {
+    auto& clock = database_.getClock();
+    clock.commit([&](uint64_t timestamp) {
+        for (const auto& table : tables) table->commit(timestamp);
+    });
+    uint64_t horizon = clock.horizon();
+    for (const auto& table : tables) table->collect(horizon);
 }
 
-auto Executor::execute(const std::unique_ptr<Command>& command) -> bool {
-    if (!command) {
-        fmt::print(std::cerr, "err: null command recieved");
-        return false;
+auto Executor::markWritten(const TablePtr& table) -> void {
+    for (const auto& written : *written_) {
+        if (written.table == table) return;
+    }
+    written_->push_back({table, table->savepoint()});
+}
+
+// tables the open transaction wrote are read with its own writes, it holds their latches so
+// nobody else has any uncommitted ones there. everything else as of the statement's snapshot
+auto Executor::rowsOf(const TablePtr& table) const -> RowView {
+    if (in_transaction_ && std::find(transaction_tables_.begin(), transaction_tables_.end(), table) != transaction_tables_.end()) {
+        return table->rows();
     }
+    return table->rows(*snapshot_);
+}
+
+auto Executor::inTransaction() const -> bool {
+    return in_transaction_;
+}
 
+auto Executor::rollbackTransaction() -> void {
+    if (!in_transaction_) return;
+    uint64_t committed = database_.getClock().committed();
+    for (const auto& table : transaction_tables_) {
+        table->rollback(0, committed); // the latch kept everyone else's writes out since BEGIN
+    }
+    transaction_tables_.clear();
+    in_transaction_ = false;
+}
+
+auto Executor::run(const Command& command, const Plan* plan) -> bool {
     try {
-        switch (command->getType()) {
+        Plan planned;
+        if (!plan) {
+            planned = Executor::plan(command, database_);
+            plan = &planned;
+        }
+        const Predicate& predicate = plan->predicate;
+
+        switch (command.getType()) {
+            case CommandType::CREATE:
+            case CommandType::DROP:
+            case CommandType::ALTER:
+            case CommandType::LOAD:
+                // the undo log only covers rows
+                if (in_transaction_) {
+                    throw std::runtime_error("CREATE, DROP, ALTER and LOAD can't run inside a transaction");
+                }
+                break;
+            default:
+                break;
+        }
+
+        switch (command.getType()) {
             case CommandType::SELECT:
-                executeSelect(static_cast<const SelectCommand&>(*command));
+                executeSelect(static_cast<const SelectCommand&>(command), *plan);
                 break;
             case CommandType::CREATE:
-                executeCreate(static_cast<const CreateCommand&>(*command));
+                executeCreate(static_cast<const CreateCommand&>(command));
                 break;
             case CommandType::DROP:
-                executeDrop(static_cast<const DropCommand&>(*command)); break;
+                executeDrop(static_cast<const DropCommand&>(command)); break;
             case CommandType::INSERT:
-                executeInsert(static_cast<const InsertCommand&>(*command));
+                executeInsert(static_cast<const InsertCommand&>(command), *plan);
                 break;
             case CommandType::UPDATE:
-                executeUpdate(static_cast<const UpdateCommand&>(*command));
+                executeUpdate(static_cast<const UpdateCommand&>(command), predicate);
                 break;
             case CommandType::DELETE:
-                executeDelete(static_cast<const DeleteCommand&>(*command));
+                executeDelete(static_cast<const DeleteCommand&>(command), predicate);
                 break;
             case CommandType::ALTER:
-                executeAlter(static_cast<const AlterCommand&>(*command));
+                executeAlter(static_cast<const AlterCommand&>(command));
                 break;
             case CommandType::SAVE:
-                executeSave(static_cast<const SaveCommand&>(*command));
+                executeSave(static_cast<const SaveCommand&>(command));
                 break;
             case CommandType::LOAD:
-                executeLoad(static_cast<const LoadCommand&>(*command));
+                executeLoad(static_cast<const LoadCommand&>(command));
                 break;
             case CommandType::SHOW:
-                executeShow(static_cast<const ShowCommand&>(*command));
+                executeShow(static_cast<const ShowCommand&>(command));
                 break;
             case CommandType::HELP:
-                executeHelp(static_cast<const HelpCommand&>(*command));
+                executeHelp(static_cast<const HelpCommand&>(command));
+                break;
+            case CommandType::BEGIN:
+            case CommandType::COMMIT:
+            case CommandType::ROLLBACK:
+                executeTransaction(static_cast<const TransactionCommand&>(command));
                 break;
             default:
-                std::cerr << "err: unsupported command type" << std::endl;
+                sink_.error("err: unsupported command type");
                 return false;
         }
         return true;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "error executing command: {}", e.what());
+        sink_.error(fmt::format("error executing command: {}", e.what()));
         return false;
     }
 }
 
-auto Executor::executeSelect(const SelectCommand& c) -> void {
+// false if the zone maps of the chunk of rows at first rule out every row of it
+static auto chunkMayMatch(const RowView& rows, size_t first, const Predicate& predicate) -> bool {
+    const RowChunk* chunk = rows.chunk(first / RowChunk::CAPACITY);
+    return !chunk || predicate.mayMatch(*chunk);
+}
+
+// calls visit with the rows that match predicate in slot order, until it returns false. chunks
+// the zone maps rule out are skipped, a chunk whose validity bits the snapshot can use only has
+// the candidates Predicate::candidates leaves looked at, IS NULL and IS NOT NULL never touch a
+// row there
+template<typename Visit>
+static auto scanMatching(const RowView& rows, const Predicate& predicate, Visit&& visit) -> void {
+    RowView::SlotMask mask;
+    for (size_t first = 0; first < rows.size(); first += RowChunk::CAPACITY) {
+        size_t end = std::min(first + RowChunk::CAPACITY, rows.size());
+        bool exact = false;
+        if (predicate.empty()) {
+            for (size_t slot = first; slot < end; slot++) {
+                const Row* row = rows.get(slot);
+                if (row && !visit(*row)) return;
+            }
+            continue;
+        }
+        if (!chunkMayMatch(rows, first, predicate)) continue;
+        if (!predicate.candidates(rows, first / RowChunk::CAPACITY, mask, exact)) {
+            for (size_t slot = first; slot < end; slot++) {
+                const Row* row = rows.get(slot);
+                if (row && predicate.evaluate(*row) && !visit(*row)) return;
+            }
+            continue;
+        }
+        for (size_t w = 0; w < mask.size(); w++) {
+            for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+                const Row* row = rows.get(first + w * 64 + std::countr_zero(bits));
+                if (!row || (!exact && !predicate.evaluate(*row))) continue;
+                if (!visit(*row)) return;
+            }
+        }
+    }
+}
+
+// COUNT(*) and COUNT(col) without GROUP BY over a table, filtered by IS NULL and IS NOT NULL at
+// most. chunks with usable validity bits are counted with popcounts of the candidate slots
+// (ANDed with the column's bits for COUNT(col)), only the rest row by row. nullopt if the
+// statement needs more than that
+static auto countRows(const RowView& rows, const Predicate& predicate, const Table& table,
+                      const std::vector<AggregateExpr>& aggregates) -> std::optional<AggregateResult> {
+    for (const auto& cond : predicate.getConditions()) {
+        // anything else is evaluated row by row, which HashAggregator spreads over threads
+        bool null_test = cond.op == CompareOp::IS_NULL || cond.op == CompareOp::IS_NOT_NULL;
+        if (!null_test || !cond.column_index) return std::nullopt;
+    }
+    std::vector<size_t> columns; // positions of the COUNT(col) columns
+    for (const auto& agg : aggregates) {
+        if (agg.function != AggregateFunction::COUNT) return std::nullopt;
+        if (agg.column_name != "*" && table.hasColumn(agg.column_name)) {
+            columns.push_back(table.getColumnIndex(agg.column_name));
+        }
+    }
+
+    std::vector<int64_t> counts(aggregates.size(), 0);
+    auto count_row = [&](const Row& row) {
+        for (size_t i = 0; i < aggregates.size(); i++) {
+            if (aggregates[i].column_name == "*") {
+                counts[i]++;
+            } else if (const Value* value = row.find(aggregates[i].column_name)) {
+                counts[i] += !value->isNull();
+            }
+        }
+    };
+    RowView::SlotMask mask, live;
+    std::vector<RowView::SlotMask> valid;
+    for (size_t first = 0; first < rows.size(); first += RowChunk::CAPACITY) {
+        size_t chunk = first / RowChunk::CAPACITY;
+        bool exact = false;
+        bool from_bits = predicate.empty()
+            ? rows.bits(chunk, columns, mask, valid)
+            : predicate.candidates(rows, chunk, mask, exact) && rows.bits(chunk, columns, live, valid);
+        if (!from_bits) {
+            size_t end = std::min(first + RowChunk::CAPACITY, rows.size());
+            for (size_t slot = first; slot < end; slot++) {
+                const Row* row = rows.get(slot);
+                if (row && predicate.evaluate(*row)) count_row(*row);
+            }
+            continue;
+        }
+        size_t column = 0;
+        for (size_t i = 0; i < aggregates.size(); i++) {
+            bool star = aggregates[i].column_name == "*";
+            if (!star && !table.hasColumn(aggregates[i].column_name)) continue; // never counts
+            const auto* bits = star ? nullptr : &valid[column++];
+            for (size_t w = 0; w < mask.size(); w++) {
+                counts[i] += std::popcount(bits ? mask[w] & (*bits)[w] : mask[w]);
+            }
+        }
+    }
+
+    AggregateGroup group;
+    for (auto count : counts) group.values.emplace_back(static_cast<int>(count));
+    return AggregateResult{std::move(group)};
+}
+
+auto Executor::executeSelect(const SelectCommand& c, const Plan& plan) -> void {
     if (c.getTableNames().empty()) {
         throw std::runtime_error("no table specified in SELECT");
     }
 
+    const auto& order_by = c.getOrderBy();
+
+    if (plan.access_path == AccessPath::JOIN) {
+        ColumnResolver resolver(resolveInputs(c));
+        std::vector<std::string> ordered_by;
+        auto rows = executeJoin(c, plan.predicate, resolver, ordered_by);
+        if (c.isAggregate()) {
+            executeAggregate(c, plan.columns, resolver, RowView(rows), Predicate());
+            return;
+        }
+        for (const auto& col : plan.columns) {
+            resolver.resolve(col); // rejects unknown and ambiguous names
+        }
+        for (const auto& item : order_by) {
+            resolver.resolve(item.column);
+        }
+        bool presorted = order_by.size() == 1 && !order_by[0].descending &&
+            std::find(ordered_by.begin(), ordered_by.end(), resolver.resolve(order_by[0].column).qualified) != ordered_by.end();
+        emitRows(c, plan.columns, std::move(rows), presorted);
+        return;
+    }
+
     const std::string& table_name = c.getTableNames()[0];
     auto table = database_.getTable(table_name);
     if (!table) {
         throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
     }
+    auto predicate = plan.predicate.boundTo(*table);
 
-    auto rows = table->getRows();
-    const auto& columns = c.getColumnNames();
-    const auto& where_clause = c.getWhereClause();
+    if (plan.access_path == AccessPath::AGGREGATE) {
+        ColumnResolver resolver({{table_name, table}});
+        executeAggregate(c, plan.columns, resolver, rowsOf(table), predicate);
+        return;
+    }
 
-    for (const auto& col : columns) {
-        fmt::print("{}\t", col);
+    for (const auto& item : order_by) {
+        if (!table->hasColumn(item.column)) {
+            throw std::runtime_error(fmt::format("column '{}' doesnt exist in table '{}'", item.column, table_name));
+        }
+    }
+
+    auto rows = rowsOf(table);
+    const auto& columns = plan.columns;
+    auto limit = c.getLimit();
+    size_t offset = c.getOffset();
+
+    // a table already stored in ORDER BY order is read like an unordered one
+    bool presorted = plan.access_path == AccessPath::SCAN ||
+        (order_by.size() == 1 && !order_by[0].descending && table->isSortedBy(order_by[0].column));
+
+    if (presorted) {
+        // rows come out in their final order, so LIMIT can stop the scan early
+        printHeader(columns);
+        size_t skipped = 0;
+        size_t printed = 0;
+        if (limit && *limit == 0) return;
+        scanMatching(rows, predicate, [&](const Row& row) {
+            if (skipped < offset) {
+                skipped++;
+                return true;
+            }
+            printRow(columns, row);
+            return !limit || ++printed < *limit;
+        });
+        return;
     }
-    fmt::print("\n");
 
+    // ORDER BY ... LIMIT only has to keep offset + limit rows around
+    if (plan.access_path == AccessPath::TOP_K) {
+        RowComparator less(order_by);
+        std::vector<DataType> types;
+        for (const auto& item : order_by) types.push_back(table->getColumn(item.column).getType());
+        less.bind(types);
+        TopK top(std::move(less), offset + *limit);
+        scanMatching(rows, predicate, [&](const Row& row) {
+            top.push(row);
+            return true;
+        });
+        auto result = top.finish();
+        applyLimit(result, offset, limit);
+        printRows(columns, result);
+        return;
+    }
+
+    // a full sort can be larger than memory, only the selected and ORDER BY columns are kept
+    // and the sort spills to temp files past the memory limit
+    std::vector<std::string> kept = columns;
+    for (const auto& item : order_by) {
+        if (std::find(kept.begin(), kept.end(), item.column) == kept.end()) kept.push_back(item.column);
+    }
+    ExternalSort sorter(order_by, sortMemoryLimit());
+    scanMatching(rows, predicate, [&](const Row& row) {
+        Row projected;
+        for (const auto& col : kept) {
+            if (row.hasColumn(col)) projected.setValue(col, row.getValue(col));
+        }
+        sorter.push(std::move(projected));
+        return true;
+    });
+    sorter.finish();
+
+    printHeader(columns);
+    size_t skipped = 0;
+    while (const Row* row = sorter.next()) {
+        if (skipped < offset) {
+            skipped++;
+            continue;
+        }
+        printRow(columns, *row);
+    }
+}
+
+// applies ORDER BY / LIMIT / OFFSET to rows that are already fully materialized and prints them
+auto Executor::emitRows(const SelectCommand& c, const std::vector<std::string>& columns,
+                        RowList rows, bool presorted) -> void {
+    const auto& order_by = c.getOrderBy();
+    auto limit = c.getLimit();
+    size_t offset = c.getOffset();
+
+    if (!presorted && !order_by.empty()) {
+        RowComparator less(order_by);
+        if (limit) {
+            TopK top(less, offset + *limit);
+            for (const auto& row : rows) {
+                top.push(row);
+            }
+            rows = top.finish();
+        } else {
+            sortRows(rows, less);
+        }
+    }
+    applyLimit(rows, offset, limit);
+    printRows(columns, rows);
+}
+
+auto Executor::printHeader(const std::vector<std::string>& columns) -> void {
+    sink_.header(columns);
+}
+
+auto Executor::printRow(const std::vector<std::string>& columns, const Row& row) -> void {
+    sink_.row(columns, row);
+}
+
+auto Executor::printRows(const std::vector<std::string>& columns, const RowList& rows) -> void {
+    printHeader(columns);
     for (const auto& row : rows) {
-        if (!where_clause.empty() && !evaluateWhereCondition(row, where_clause)) {
-            continue; // skip rows that don't match the WHERE condition
+        printRow(columns, row);
+    }
+}
+
+auto Executor::resolveInputs(const SelectCommand& c) -> std::vector<JoinInput> {
+    std::vector<JoinInput> inputs;
+    for (const auto& table_name : c.getTableNames()) {
+        auto table = database_.getTable(table_name);
+        if (!table) {
+            throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
         }
+        for (const auto& input : inputs) {
+            if (input.name == table_name) {
+                throw std::runtime_error(fmt::format("table '{}' specified more than once", table_name));
+            }
+        }
+        inputs.push_back({table_name, table});
+    }
+    return inputs;
+}
+
+// true if the column alone is a PRIMARY KEY or UNIQUE, i.e. joining on it matches at most one row
+static auto isUniqueColumn(const Table& table, const std::string& column) -> bool {
+    for (const auto& constraint : table.getConstraints()) {
+        std::vector<std::string> columns;
+        if (auto pk = std::dynamic_pointer_cast<PrimaryKeyConstraint>(constraint)) {
+            columns = pk->getColumnNames();
+        } else if (auto unique = std::dynamic_pointer_cast<UniqueConstraint>(constraint)) {
+            columns = unique->getColumnNames();
+        }
+        if (columns.size() == 1 && columns[0] == column) return true;
+    }
+    return false;
+}
+
+auto Executor::executeJoin(const SelectCommand& c, const Predicate& predicate,
+                           const ColumnResolver& resolver, std::vector<std::string>& ordered_by) -> RowList {
+    const auto& inputs = resolver.getInputs();
+
+    // ORDER BY on the key of the last join is cheaper to get from a merge join over
+    // sorted inputs than from sorting the joined rows
+    std::string wanted_order;
+    const auto& order_by = c.getOrderBy();
+    if (!c.isAggregate() && order_by.size() == 1 && !order_by[0].descending) {
+        wanted_order = resolver.resolve(order_by[0].column).qualified;
+    }
+
+    // sort the conditions: single-input ones are pushed below the join, equalities between
+    // two inputs become join keys, the rest is evaluated on the joined rows
+    struct JoinEdge {
+        size_t left_input, right_input;
+        std::string left_column, right_column; // qualified
+        bool used = false;
+    };
+    std::vector<std::vector<Condition>> pushed(inputs.size());
+    std::vector<JoinEdge> edges;
+    std::vector<Condition> residual;
+
+    for (const auto& where : predicate.getConditions()) {
+        auto cond = where;
+        auto lhs = resolver.resolve(cond.column);
+        if (!cond.rhs_is_column) {
+            cond.chooseKernel(lhs.column->getType());
+            pushed[lhs.input].push_back(std::move(cond));
+            continue;
+        }
+        auto rhs = resolver.resolve(cond.rhs_column);
+        cond.chooseKernel(lhs.column->getType(), rhs.column->getType());
+        if (lhs.input == rhs.input) {
+            pushed[lhs.input].push_back(std::move(cond));
+        } else if (cond.op == CompareOp::EQ) {
+            edges.push_back({lhs.input, rhs.input, lhs.qualified, rhs.qualified});
+        } else {
+            residual.push_back(std::move(cond));
+        }
+    }
 
-        // print the row if it passes the WHERE clause
-        for (const auto& col : columns) {
-            if (row.hasColumn(col)) {
-                const auto& value = row.getValue(col);
-                if (!value.isNull()) {
-                    fmt::print("{}\t", value.toString());
+    // inputs are scanned lazily: a hash join materializes its inputs, a merge join pulls rows
+    // one at a time. rows get "table.col" names so the inputs can't clash
+    std::vector<std::optional<RowList>> scanned(inputs.size());
+    auto scan = [&](size_t i) -> RowList& {
+        if (!scanned[i]) {
+            Predicate filter(pushed[i]);
+            RowList rows;
+            for (const auto& row : rowsOf(inputs[i].table)) {
+                auto qualified = resolver.qualify(i, row);
+                if (filter.evaluate(qualified)) {
+                    rows.push_back(std::move(qualified));
+                }
+            }
+            scanned[i] = std::move(rows);
+        }
+        return *scanned[i];
+    };
+    auto table_cursor = [&](size_t i) -> RowCursor {
+        return [rows = rowsOf(inputs[i].table), &resolver, filter = Predicate(pushed[i]),
+                i, pos = size_t{0}, current = Row()]() mutable -> const Row* {
+            while (pos < rows.size()) {
+                const Row* row = rows.get(pos++);
+                if (!row) continue;
+                current = resolver.qualify(i, *row);
+                if (filter.evaluate(current)) return &current;
+            }
+            return nullptr;
+        };
+    };
+    auto list_cursor = [](const RowList& rows) -> RowCursor {
+        return [&rows, pos = size_t{0}]() mutable -> const Row* {
+            return pos < rows.size() ? &rows[pos++] : nullptr;
+        };
+    };
+
+    // left-deep join order: always continue with an input connected to what is joined so far.
+    // until the first join the left side is just input 0, which hasn't been scanned yet
+    std::vector<bool> joined(inputs.size(), false);
+    std::optional<RowList> result;
+    std::vector<std::string> result_order; // qualified columns the joined rows are sorted by
+    joined[0] = true;
+    size_t joined_count = 1;
+
+    while (joined_count < inputs.size()) {
+        size_t next = inputs.size();
+        for (const auto& edge : edges) {
+            if (joined[edge.left_input] != joined[edge.right_input]) {
+                next = joined[edge.left_input] ? edge.right_input : edge.left_input;
+                break;
+            }
+        }
+
+        if (next == inputs.size()) {
+            // no equality connects the rest, fall back to a cross product
+            next = std::find(joined.begin(), joined.end(), false) - joined.begin();
+            result = HashJoin::crossJoin(result ? *result : scan(0), scan(next));
+            result_order.clear();
+        } else {
+            std::vector<std::string> left_keys, right_keys;
+            for (auto& edge : edges) {
+                if (edge.used) continue;
+                if (joined[edge.left_input] && edge.right_input == next) {
+                    left_keys.push_back(edge.left_column);
+                    right_keys.push_back(edge.right_column);
+                    edge.used = true;
+                } else if (joined[edge.right_input] && edge.left_input == next) {
+                    left_keys.push_back(edge.right_column);
+                    right_keys.push_back(edge.left_column);
+                    edge.used = true;
+                }
+            }
+
+            // a merge join pays off when both sides already come ordered by the key (filtering
+            // keeps that order, so a sorted table stays sorted after the pushed down conditions)
+            // or when ORDER BY asks for the key order anyway and the inputs get sorted for it
+            bool merge = false;
+            bool left_sorted = false;
+            bool right_sorted = false;
+            if (left_keys.size() == 1) {
+                auto left_col = resolver.resolve(left_keys[0]);
+                auto right_col = resolver.resolve(right_keys[0]);
+                left_sorted = result
+                    ? std::find(result_order.begin(), result_order.end(), left_col.qualified) != result_order.end()
+                    : inputs[0].table->isSortedBy(left_col.column->getName());
+                right_sorted = inputs[next].table->isSortedBy(right_col.column->getName());
+                bool for_order = joined_count + 1 == inputs.size() && !wanted_order.empty() &&
+                                 (left_col.qualified == wanted_order || right_col.qualified == wanted_order);
+                merge = (for_order || (left_sorted && right_sorted)) &&
+                        left_col.column->getType() == right_col.column->getType();
+            }
+
+            if (merge) {
+                RowCursor left, right;
+                if (left_sorted) {
+                    left = result ? list_cursor(*result) : table_cursor(0);
+                } else {
+                    auto& rows = result ? *result : scan(0);
+                    sortRows(rows, RowComparator({{left_keys[0]}}));
+                    left = list_cursor(rows);
+                }
+                if (right_sorted) {
+                    right = table_cursor(next);
                 } else {
-                    fmt::print("NULL\t");
+                    auto& rows = scan(next);
+                    sortRows(rows, RowComparator({{right_keys[0]}}));
+                    right = list_cursor(rows);
                 }
+                result = SortMergeJoin::join(left, right, left_keys[0], right_keys[0]);
+                result_order = {left_keys[0], right_keys[0]};
             } else {
-                fmt::print("NULL\t");
+                // uniqueness is only known for base tables, not for intermediate results
+                auto unique_key = [&](size_t input, const std::vector<std::string>& keys) {
+                    return keys.size() == 1 &&
+                           isUniqueColumn(*inputs[input].table, resolver.resolve(keys[0]).column->getName());
+                };
+                bool left_unique = !result && unique_key(0, left_keys);
+                bool right_unique = unique_key(next, right_keys);
+                result = HashJoin::join(result ? *result : scan(0), scan(next), left_keys, right_keys, left_unique, right_unique);
+                result_order.clear();
             }
         }
-        fmt::print("\n");
+        joined[next] = true;
+        joined_count++;
+    }
+
+    // equalities between inputs that were already joined through other edges
+    for (const auto& edge : edges) {
+        if (!edge.used) {
+            residual.push_back(Condition{edge.left_column, CompareOp::EQ, true, edge.right_column, Value()});
+        }
+    }
+    if (!residual.empty()) {
+        Predicate filter(std::move(residual));
+        std::erase_if(*result, [&filter](const Row& row) { return !filter.evaluate(row); });
+    }
+    ordered_by = result_order;
+    return std::move(*result);
+}
+
+auto Executor::executeAggregate(const SelectCommand& c, const std::vector<std::string>& columns,
+                                const ColumnResolver& resolver, const RowView& rows,
+                                const Predicate& predicate) -> void {
+    const auto& group_by = c.getGroupBy();
+    const auto& aggregates = c.getAggregates();
+
+    for (const auto& col : group_by) {
+        resolver.resolve(col);
+    }
+    for (const auto& agg : aggregates) {
+        if (agg.column_name == "*") continue;
+        auto type = resolver.resolve(agg.column_name).column->getType();
+        bool numeric = type == DataType::INTEGER || type == DataType::FLOAT;
+        if (!numeric && (agg.function == AggregateFunction::SUM || agg.function == AggregateFunction::AVG)) {
+            throw std::runtime_error(fmt::format("{} requires a numeric column, '{}' is {}",
+                aggregateFunctionToString(agg.function), agg.column_name, dataTypeToString(type)));
+        }
+    }
+
+    // map every output column either to a grouping column or to an aggregate
+    struct OutputColumn {
+        bool is_aggregate;
+        size_t index;
+    };
+    std::vector<OutputColumn> output;
+    for (const auto& col : columns) {
+        auto agg_it = std::find_if(aggregates.begin(), aggregates.end(),
+            [&col](const AggregateExpr& a) { return a.toString() == col; });
+        if (agg_it != aggregates.end()) {
+            output.push_back({true, static_cast<size_t>(std::distance(aggregates.begin(), agg_it))});
+            continue;
+        }
+        auto group_it = std::find(group_by.begin(), group_by.end(), col);
+        if (group_it == group_by.end()) {
+            throw std::runtime_error(fmt::format("column '{}' must appear in GROUP BY or be used in an aggregate", col));
+        }
+        output.push_back({false, static_cast<size_t>(std::distance(group_by.begin(), group_it))});
+    }
+
+    HashAggregator::RowFilter filter = nullptr;
+    if (!predicate.empty()) {
+        filter = [&predicate](const Row& row) { return predicate.evaluate(row); };
+    }
+
+    for (const auto& item : c.getOrderBy()) {
+        if (std::find(columns.begin(), columns.end(), item.column) == columns.end()) {
+            throw std::runtime_error(fmt::format("ORDER BY column '{}' must appear in the select list", item.column));
+        }
+    }
+
+    std::optional<AggregateResult> counted;
+    if (group_by.empty() && resolver.getInputs().size() == 1) {
+        counted = countRows(rows, predicate, *resolver.getInputs()[0].table, aggregates);
+    }
+    HashAggregator aggregator(group_by, aggregates);
+    auto groups = counted ? std::move(*counted) : aggregator.aggregateParallel(rows, filter);
+
+    RowList result;
+    result.reserve(groups.size());
+    for (const auto& group : groups) {
+        Row row;
+        for (size_t i = 0; i < output.size(); i++) {
+            const auto& out = output[i];
+            row.setValue(columns[i], out.is_aggregate ? group.values[out.index] : group.key[out.index]);
+        }
+        result.push_back(std::move(row));
     }
+    emitRows(c, columns, std::move(result), false);
 }
 
 auto Executor::executeCreate(const CreateCommand& c) -> void {
@@ -168,7 +790,8 @@ auto Executor::executeCreate(const CreateCommand& c) -> void {
         table->addConstraint(constraint);
     }
     database_.addTable(table);
-    fmt::println("table '{}' created successfully", table_name);
+    database_.schemaChanged();
+    sink_.message(fmt::format("table '{}' created successfully", table_name));
 }
 
 auto Executor::executeDrop(const DropCommand& c) -> void {
@@ -178,13 +801,14 @@ auto Executor::executeDrop(const DropCommand& c) -> void {
         throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
     }
     if (database_.dropTable(table_name)) {
-        fmt::println("table '{}' dropped successfully", table_name);
+        database_.schemaChanged();
+        sink_.message(fmt::format("table '{}' dropped successfully", table_name));
     } else {
         throw std::runtime_error(fmt::format("failed to drop table '{}'", table_name));
     }
 }
 
-auto Executor::executeInsert(const InsertCommand& c) -> void {
+auto Executor::executeInsert(const InsertCommand& c, const Plan& plan) -> void {
     const std::string& table_name = c.getTableName();
     auto table = database_.getTable(table_name);
 
@@ -192,15 +816,28 @@ auto Executor::executeInsert(const InsertCommand& c) -> void {
         throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
     }
 
-    const auto& column_names = c.getColumnNames();
+    const auto& column_names = plan.columns;
     const auto& values = c.getValues();
 
     if (values.empty()) {
         throw std::runtime_error("no values provided for INSERT");
     }
 
-    // for each set of values -> insert a row
+    // columns left out get their DEFAULT, as the rows from before an ADD COLUMN ... DEFAULT read it
+    std::vector<std::pair<std::string, Value>> defaults;
+    for (const auto& column : table->getColumns()) {
+        if (std::find(column_names.begin(), column_names.end(), column.getName()) != column_names.end()) continue;
+        for (const auto& constraint : column.getConstraints()) {
+            if (constraint->getType() == ConstraintType::DEFAULT) {
+                defaults.emplace_back(column.getName(), static_cast<const DefaultConstraint&>(*constraint).getDefaultValue());
+            }
+        }
+    }
+
+    // for each set of values -> insert a row. if one fails the ones before are undone with it
+    markWritten(table);
     for (const auto& value_set : values) {
+        checkMemoryLimit();
         if (value_set.size() != column_names.size()) {
             throw std::runtime_error(fmt::format("mismatch between number of columns ({}) and values ({})", 
                 column_names.size(), value_set.size()));
@@ -210,6 +847,9 @@ auto Executor::executeInsert(const InsertCommand& c) -> void {
         for (int i = 0; i < column_names.size(); i++) {
             row.setValue(column_names[i], value_set[i]);
         }
+        for (const auto& [column, value] : defaults) {
+            row.setValue(column, value);
+        }
         if (!database_.validateRow(table_name, row)) {
             throw std::runtime_error(fmt::format("row validation failed for table '{}'", table_name));
         }
@@ -217,10 +857,10 @@ auto Executor::executeInsert(const InsertCommand& c) -> void {
         table->addRow(row);
     }
 
-    fmt::println("successfully inserted ({}) row(s) into {}", values.size(), table_name);
+    sink_.message(fmt::format("successfully inserted ({}) row(s) into {}", values.size(), table_name));
 }
 
-auto Executor::executeUpdate(const UpdateCommand& c) -> void {
+auto Executor::executeUpdate(const UpdateCommand& c, const Predicate& predicate) -> void {
     const std::string& table_name = c.getTableName();
     if (table_name.empty()) {
         throw std::runtime_error("no table specified in UPDATE");
@@ -232,27 +872,32 @@ auto Executor::executeUpdate(const UpdateCommand& c) -> void {
     }
 
     const auto& updates = c.getColumnValues();
-    const auto& where_clause = c.getWhereClause();
     int updated_count = 0;
 
     // Process each row directly using the table's row reference
-    for (size_t i = 0; i < table->rowCount(); i++) {
-        Row& row = table->getRow(i);
+    auto where = predicate.boundTo(*table);
+    auto rows = table->rows();
+    for (RowId i = 0; i < rows.size(); i++) {
+        if (i % RowChunk::CAPACITY == 0 && !chunkMayMatch(rows, i, where)) {
+            i += RowChunk::CAPACITY - 1;
+            continue;
+        }
+        const Row* row = rows.get(i);
         
         // Apply WHERE clause filtering if present
-        if (evaluateWhereCondition(row, where_clause)) {
+        if (row && where.evaluate(*row)) {
             // Update the row if it matches the WHERE condition
-            for (const auto& [col_name, value] : updates) {
-                row.setValue(col_name, value);
-            }
+            checkMemoryLimit();
+            markWritten(table);
+            table->updateRow(i, updates);
             updated_count++;
         }
     }
 
-    fmt::println("successfully updated ({}) row(s) in {}", updated_count, table_name);
+    sink_.message(fmt::format("successfully updated ({}) row(s) in {}", updated_count, table_name));
 }
 
-auto Executor::executeDelete(const DeleteCommand& c) -> void {
+auto Executor::executeDelete(const DeleteCommand& c, const Predicate& predicate) -> void {
     const std::string& table_name = c.getTableName();
     if (table_name.empty()) {
         throw std::runtime_error("no table specified in DELETE");
@@ -263,41 +908,33 @@ auto Executor::executeDelete(const DeleteCommand& c) -> void {
         throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
     }
 
-    const auto& where_clause = c.getWhereClause();
-    
     // if there's no WHERE, delete all  
-    if (where_clause.empty()) {
+    if (predicate.empty()) {
         size_t row_count = table->rowCount();
+        markWritten(table);
         table->clearRows();
-        fmt::println("successfully deleted ({}) row(s) from '{}'", row_count, table_name);
+        sink_.message(fmt::format("successfully deleted ({}) row(s) from '{}'", row_count, table_name));
         return;
     }
 
-    // find rows that match 
-    std::vector<size_t> rows_to_delete;
-    for (size_t i = 0; i < table->rowCount(); i++) {
-        const Row& row = table->getRow(i);
-        if (evaluateWhereCondition(row, where_clause)) {
-            rows_to_delete.push_back(i);
-        }
-    }
-
-    // exclude
+    // the other rows keep their slots, snapshots that still see the deleted ones keep reading them
     int deleted_count = 0;
-    RowList new_rows;
-    for (size_t i = 0; i < table->rowCount(); i++) {
-        if (std::find(rows_to_delete.begin(), rows_to_delete.end(), i) == rows_to_delete.end()) {
-            new_rows.push_back(table->getRow(i));
-        } else {
+    auto where = predicate.boundTo(*table);
+    auto rows = table->rows();
+    for (RowId i = 0; i < rows.size(); i++) {
+        if (i % RowChunk::CAPACITY == 0 && !chunkMayMatch(rows, i, where)) {
+            i += RowChunk::CAPACITY - 1;
+            continue;
+        }
+        const Row* row = rows.get(i);
+        if (row && where.evaluate(*row)) {
+            markWritten(table);
+            table->deleteRow(i);
             deleted_count++;
         }
     }
-    table->clearRows();
-    for (const auto& row : new_rows) {
-        table->addRow(row);
-    }
 
-    fmt::println("successfully deleted ({}) row(s) from '{}'", deleted_count, table_name);
+    sink_.message(fmt::format("successfully deleted ({}) row(s) from '{}'", deleted_count, table_name));
 }
 
 auto Executor::executeAlter(const AlterCommand& c) -> void {
@@ -306,6 +943,7 @@ auto Executor::executeAlter(const AlterCommand& c) -> void {
     if (!table) {
         throw std::runtime_error(fmt::format("table '{}' doesn't exist", table_name));
     }
+    database_.schemaChanged(); // plans made before this may name columns that are gone
 
     switch (c.getAlterType()) {
         case AlterCommand::AlterType::ADD: {
@@ -315,8 +953,8 @@ auto Executor::executeAlter(const AlterCommand& c) -> void {
                     new_column.getName(), table_name));
             }
             table->addColumn(new_column);
-            fmt::println("successfully added column '{}' to table '{}'", 
-                new_column.getName(), table_name);
+            sink_.message(fmt::format("successfully added column '{}' to table '{}'", 
+                new_column.getName(), table_name));
             break;
         }
         case AlterCommand::AlterType::DROP: {
@@ -326,8 +964,8 @@ auto Executor::executeAlter(const AlterCommand& c) -> void {
                     column_name, table_name));
             }
             table->dropColumn(column_name);
-            fmt::println("successfully dropped column '{}' from table '{}'", 
-                column_name, table_name);
+            sink_.message(fmt::format("successfully dropped column '{}' from table '{}'", 
+                column_name, table_name));
             break;
         }
         case AlterCommand::AlterType::RENAME: {
@@ -342,13 +980,15 @@ auto Executor::executeAlter(const AlterCommand& c) -> void {
                     new_name, table_name));
             }
             table->renameColumn(old_name, new_name);
-            fmt::println("successfully renamed column '{}' to '{}' in table '{}'", 
-                old_name, new_name, table_name);
+            sink_.message(fmt::format("successfully renamed column '{}' to '{}' in table '{}'", 
+                old_name, new_name, table_name));
             break;
         }
     }
 }
 
+static constexpr size_t SAVE_WRITE_BYTES = 64 * 1024;
+
 auto Executor::executeSave(const SaveCommand& c) -> void {
     const std::string& filename = c.getFilename();
     
@@ -361,6 +1001,7 @@ auto Executor::executeSave(const SaveCommand& c) -> void {
         throw std::runtime_error(fmt::format("failed to open file '{}' for saving", filename));
     }
 
+    std::string out;
     for (const auto& tableName : database_.getTableNames()) {
         auto table = database_.getTable(tableName);
 
@@ -434,36 +1075,50 @@ auto Executor::executeSave(const SaveCommand& c) -> void {
             }
         }
         createCmd += ")";
-        file << createCmd << std::endl;
-
-        // generate inserts for all rows
-        const auto& rows = table->getRows();
-        for (const auto& row : rows) {
-            const auto& values = row.getValues();
-            if (values.empty()) continue;
-
-            std::string insert_cmd = fmt::format("INSERT INTO {} VALUES (", tableName);
-
-            size_t i = 0;
-            for (const auto& [colName, val] : values) {
-                if (val.getType() == DataType::STRING) {
-                    insert_cmd += fmt::format("'{}'", val.toString());
+        out += createCmd;
+        out += '\n';
+
+        // generate inserts for all rows, every table as of the same snapshot. they are built in
+        // one buffer that goes to the file SAVE_WRITE_BYTES at a time
+        for (const auto& row : table->rows(*snapshot_)) {
+            if (row.getValues().empty()) continue;
+
+            out += "INSERT INTO ";
+            out += tableName;
+            out += " VALUES (";
+
+            // in column order, the row's own map has none. rows go out in slot order, so loading
+            // them hands out dictionary codes in the order they were handed out here
+            for (size_t i = 0; i < columns.size(); ++i) {
+                const Value* val = row.find(columns[i].getName());
+                if (!val) {
+                    out += "NULL";
+                } else if (val->getType() == DataType::STRING) {
+                    out += '\'';
+                    val->appendTo(out);
+                    out += '\'';
                 } else {
-                    insert_cmd+= val.toString();
+                    val->appendTo(out);
                 }
 
-                if (i < values.size() - 1) {
-                    insert_cmd+= ", ";
+                if (i < columns.size() - 1) {
+                    out += ", ";
                 }
-                ++i;
             }
-            insert_cmd += ")";
-            file << insert_cmd << std::endl;
+            out += ")\n";
+            if (out.size() >= SAVE_WRITE_BYTES) {
+                file.write(out.data(), static_cast<std::streamsize>(out.size()));
+                out.clear();
+            }
         }
     }
-    
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+
     file.close();
-    fmt::println("database state saved as commands to '{}'", filename);
+    if (!file) {
+        throw std::runtime_error(fmt::format("failed to write file '{}'", filename));
+    }
+    sink_.message(fmt::format("database state saved as commands to '{}'", filename));
 }
 
 auto Executor::executeLoad(const LoadCommand& c) -> void {
@@ -480,29 +1135,32 @@ auto Executor::executeLoad(const LoadCommand& c) -> void {
     }
     database_.clear();
 
+    Parser parser; // one for the whole file, its buffers are reused per line
     std::string line;
     while (std::getline(file, line)) {
         if (!line.empty()) {
             try {
-                Parser parser(database_);
                 auto command = parser.parse(line);
                 if (command) {
-                    // skip SAVE and LOAD commands, avoids recursion
+                    // skip SAVE and LOAD commands, avoids recursion. every loaded statement commits on its own
                     if (command->getType() != CommandType::SAVE && 
-                        command->getType() != CommandType::LOAD) {
+                        command->getType() != CommandType::LOAD &&
+                        command->getType() != CommandType::BEGIN &&
+                        command->getType() != CommandType::COMMIT &&
+                        command->getType() != CommandType::ROLLBACK) {
                         execute(command);
                     }
                 } else {
-                    fmt::print(std::cerr, "warning: failed to parse command: {}\n", line);
+                    sink_.error(fmt::format("warning: failed to parse command: {}", line));
                 }
             } catch (const std::exception& e) {
-                fmt::print(std::cerr, "warning: error executing command '{}': {}\n", line, e.what());
+                sink_.error(fmt::format("warning: error executing command '{}': {}", line, e.what()));
             }
         }
     }
 
     file.close();
-    fmt::println("database state loaded from '{}'", filename);
+    sink_.message(fmt::format("database state loaded from '{}'", filename));
 }
 
 auto Executor::executeShow(const ShowCommand& c) -> void {
@@ -510,12 +1168,12 @@ auto Executor::executeShow(const ShowCommand& c) -> void {
         case ShowCommand::ShowType::TABLES: {
             auto table_names = database_.getTableNames();
             if (table_names.empty()) {
-                fmt::println("no tables in database");
+                sink_.message("no tables in database");
                 return;
             }
-            fmt::println("Tables in database:");
+            sink_.message("Tables in database:");
             for (const auto& name : table_names) {
-                fmt::println("- {}", name);
+                sink_.message(fmt::format("- {}", name));
             }
             break;
         }
@@ -526,9 +1184,61 @@ auto Executor::executeShow(const ShowCommand& c) -> void {
                 throw std::runtime_error(fmt::format("table '{}' doesn't exist", table_name));
             }
             const auto& columns = table->getColumns();
-            fmt::println("Columns in table '{}':", table_name);
+            sink_.message(fmt::format("Columns in table '{}':", table_name));
             for (const auto& column : columns) {
-                fmt::println("- {} ({})", column.getName(), dataTypeToString(column.getType()));
+                const auto* dictionary = table->dictionary(column.getName());
+                if (!dictionary) {
+                    sink_.message(fmt::format("- {} ({})", column.getName(), dataTypeToString(column.getType())));
+                } else if (dictionary->isPlain()) {
+                    sink_.message(fmt::format("- {} ({}, plain)", column.getName(), dataTypeToString(column.getType())));
+                } else {
+                    sink_.message(fmt::format("- {} ({}, dictionary of {})", column.getName(),
+                        dataTypeToString(column.getType()), dictionary->size()));
+                }
+            }
+            break;
+        }
+        case ShowCommand::ShowType::MEMORY: {
+            size_t limit = memoryLimit();
+            if (c.getTableName().empty()) {
+                sink_.message(limit ? fmt::format("Memory in use: {} bytes, limit {} bytes", memoryInUse(), limit)
+                                    : fmt::format("Memory in use: {} bytes, no limit", memoryInUse()));
+                for (const auto& name : database_.getTableNames()) {
+                    auto table = database_.getTable(name);
+                    if (!table) continue;
+                    auto use = table->memoryUse();
+                    size_t allocated = use.rows + use.index;
+                    for (const auto& column : table->getColumns()) {
+                        if (const auto* dictionary = table->dictionary(column.getName())) {
+                            allocated += dictionary->allocated();
+                        }
+                    }
+                    size_t payload = 0;
+                    for (size_t bytes : use.column_payload) payload += bytes;
+                    sink_.message(fmt::format("- {}: {} bytes allocated, {} bytes of payload", name, allocated, payload));
+                }
+                break;
+            }
+
+            const std::string& table_name = c.getTableName();
+            auto table = database_.getTable(table_name);
+            if (!table) {
+                throw std::runtime_error(fmt::format("table '{}' doesn't exist", table_name));
+            }
+            auto use = table->memoryUse();
+            const auto& columns = table->getColumns();
+            sink_.message(fmt::format("Memory of table '{}':", table_name));
+            sink_.message(fmt::format("- rows: {} bytes allocated", use.rows));
+            sink_.message(fmt::format("- index (bitmaps and zone maps): {} bytes allocated", use.index));
+            for (size_t i = 0; i < columns.size(); i++) {
+                std::string line = fmt::format("- column {}: {} bytes allocated, {} bytes of payload",
+                    columns[i].getName(), use.column_allocated[i], use.column_payload[i]);
+                const auto* dictionary = table->dictionary(columns[i].getName());
+                if (dictionary && !dictionary->isPlain()) {
+                    line += fmt::format(", string heap {} bytes allocated, {} bytes of payload",
+                        dictionary->allocated(), dictionary->payload());
+                }
+                sink_.message(line);
             }
             break;
         }
@@ -537,10 +1247,18 @@ auto Executor::executeShow(const ShowCommand& c) -> void {
 
 auto Executor::executeHelp(const HelpCommand& c) -> void {
     std::map<std::string, std::string> commands = {
-        {"SELECT", "SELECT column1, column2, ... FROM table_name [WHERE condition]\n"
+        {"SELECT", "SELECT column1, column2, ... FROM table_name [JOIN table_name ON a.col = b.col ...] [WHERE condition [AND condition ...]]\n"
+                  "       [GROUP BY column1, ...] [ORDER BY column1 [ASC|DESC], ...] [LIMIT n [OFFSET m]]\n"
                   "  - Retrieves data from a table\n"
+                  "  - Tables can be joined with JOIN ... ON or listed comma separated with the join condition in WHERE\n"
                   "  - Use * to select all columns\n"
-                  "  - Example: SELECT * FROM employees WHERE salary > 50000"},
+                  "  - Aggregates: COUNT(*), COUNT(col), SUM(col), AVG(col), MIN(col), MAX(col)\n"
+                  "  - A condition can also be column IN (value1, value2, ...) or column IS [NOT] NULL\n"
+                  "  - Example: SELECT * FROM employees WHERE salary > 50000\n"
+                  "  - Example: SELECT * FROM employees WHERE department IN ('sales', 'support')\n"
+                  "  - Example: SELECT name, salary FROM employees ORDER BY salary DESC LIMIT 20\n"
+                  "  - Example: SELECT department, COUNT(*), AVG(salary) FROM employees GROUP BY department\n"
+                  "  - Example: SELECT employees.name, departments.name FROM employees JOIN departments ON employees.dept_id = departments.id"},
                   
         {"CREATE", "CREATE TABLE table_name (column1 TYPE, column2 TYPE, ...)\n"
                   "  - Creates a new table with specified columns\n"
@@ -564,15 +1282,20 @@ auto Executor::executeHelp(const HelpCommand& c) -> void {
                 "  - Deletes an entire table\n"
                 "  - Example: DROP TABLE employees"},
                 
-        {"ALTER", "ALTER TABLE table_name ADD column_name TYPE\n"
+        {"ALTER", "ALTER TABLE table_name ADD column_name TYPE [DEFAULT value]\n"
                  "ALTER TABLE table_name DROP COLUMN column_name\n"
                  "ALTER TABLE table_name RENAME COLUMN old_name TO new_name\n"
                  "  - Modifies the structure of a table\n"
+                 "  - Rows already there aren't rewritten, they read the DEFAULT of an added column\n"
                  "  - Example: ALTER TABLE employees ADD department STRING"},
                  
         {"SHOW", "SHOW TABLES\n"
                "SHOW COLUMNS FROM table_name\n"
+               "SHOW MEMORY [table_name]\n"
                "  - Lists tables in the database or columns in a table\n"
+               "  - MEMORY shows the bytes allocated and the bytes of data held, per table or per column\n"
+               "    of one. DB_MEMORY_LIMIT (bytes, K/M/G suffix allowed) caps the process: past it\n"
+               "    INSERT and UPDATE fail and sorts spill to disk early\n"
                "  - Example: SHOW COLUMNS FROM employees"},
                
         {"SAVE", "SAVE 'filename'\n"
@@ -583,6 +1306,27 @@ auto Executor::executeHelp(const HelpCommand& c) -> void {
                "  - Loads a database from a file\n"
                "  - Example: LOAD FROM 'my_database.db'"},
                
+        {"PREPARE", "PREPARE name AS statement\n"
+               "  - Parses and binds a SELECT, INSERT, UPDATE or DELETE once, $1, $2, ... mark the parameters\n"
+               "  - Example: PREPARE add_emp AS INSERT INTO employees VALUES ($1, $2, $3)"},
+
+        {"EXECUTE", "EXECUTE name(value1, value2, ...)\n"
+               "  - Runs a prepared statement with the given parameters\n"
+               "  - Example: EXECUTE add_emp(1, 'John Doe', 75000)"},
+
+        {"BEGIN", "BEGIN\n"
+               "  - Starts a transaction, the statements up to COMMIT apply together or not at all\n"
+               "  - Other clients see none of its changes before COMMIT, CREATE, DROP, ALTER and LOAD aren't allowed in it\n"
+               "  - Example: BEGIN"},
+
+        {"COMMIT", "COMMIT\n"
+               "  - Makes all changes of the open transaction visible at once\n"
+               "  - Example: COMMIT"},
+
+        {"ROLLBACK", "ROLLBACK\n"
+               "  - Throws away all changes of the open transaction\n"
+               "  - Example: ROLLBACK"},
+
         {"HELP", "HELP [command_name]\n"
                "  - Displays information about commands\n"
                "  - Example: HELP CREATE"},
@@ -595,19 +1339,47 @@ auto Executor::executeHelp(const HelpCommand& c) -> void {
         const std::string& command_name = c.getCommandName();
         auto it = commands.find(command_name);
         if (it != commands.end()) {
-            fmt::println("Help for {} command:", command_name);
-            fmt::println("{}", it->second);
+            sink_.message(fmt::format("Help for {} command:", command_name));
+            sink_.message(it->second);
         } else {
-            fmt::println("Unknown command: {}", command_name);
-            fmt::println("Type HELP to see all available commands.");
+            sink_.message(fmt::format("Unknown command: {}", command_name));
+            sink_.message("Type HELP to see all available commands.");
         }
     } else {
-        fmt::println("Available commands:");
-        fmt::println("-------------------");
+        sink_.message("Available commands:");
+        sink_.message("-------------------");
         for (const auto& [cmd, _] : commands) {
-            fmt::println("{}", cmd);
+            sink_.message(cmd);
         }
-        fmt::println("\nType HELP command_name for detailed information on a specific command.");
+        sink_.message("\nType HELP command_name for detailed information on a specific command.");
+    }
+}
+
+auto Executor::executeTransaction(const TransactionCommand& c) -> void {
+    switch (c.getType()) {
+        case CommandType::BEGIN:
+            if (in_transaction_) {
+                throw std::runtime_error("a transaction is already open");
+            }
+            in_transaction_ = true;
+            sink_.message("transaction started");
+            break;
+        case CommandType::COMMIT:
+            if (!in_transaction_) {
+                throw std::runtime_error("no transaction is open");
+            }
+            if (!transaction_tables_.empty()) commit(transaction_tables_); // under one timestamp
+            transaction_tables_.clear();
+            in_transaction_ = false;
+            sink_.message("transaction committed");
+            break;
+        default:
+            if (!in_transaction_) {
+                throw std::runtime_error("no transaction is open");
+            }
+            rollbackTransaction();
+            sink_.message("transaction rolled back");
+            break;
     }
 }
 
@@ -7,27 +7,65 @@
 #include "Commands.hpp"
 #include "Database.hpp"
 #include "Parser.hpp"
+#include "Join.hpp"
+#include "Mvcc.hpp"
+#include "Predicate.hpp"
+#include "Plan.hpp"
+#include "ResultSink.hpp"
 
 class Executor {
 private:
     Database& database_;
+    ResultSink& sink_;
+    struct Written {
+        TablePtr table;
+        size_t savepoint; // end of the table's undo log before the statement wrote it
+    };
+    const Snapshot* snapshot_ = nullptr;    // what the running statement reads
+    std::vector<Written>* written_ = nullptr; // tables it wrote, committed when it ends or undone if it fails
+    bool in_transaction_ = false;
+    std::vector<TablePtr> transaction_tables_; // written since BEGIN, committed or rolled back together
 
-    void executeSelect(const SelectCommand& command);
+    bool run(const Command& command, const Plan* plan);
+    void markWritten(const TablePtr& table); // before the statement's first write to table
+    RowView rowsOf(const TablePtr& table) const;
+    void commit(const std::vector<TablePtr>& tables);
+
+    void executeSelect(const SelectCommand& command, const Plan& plan);
+    std::vector<JoinInput> resolveInputs(const SelectCommand& command);
+    RowList executeJoin(const SelectCommand& command, const Predicate& predicate,
+                        const ColumnResolver& resolver, std::vector<std::string>& ordered_by);
+    void executeAggregate(const SelectCommand& command, const std::vector<std::string>& columns,
+                          const ColumnResolver& resolver, const RowView& rows, const Predicate& predicate);
+    void emitRows(const SelectCommand& command, const std::vector<std::string>& columns, RowList rows, bool presorted);
+    void printHeader(const std::vector<std::string>& columns);
+    void printRow(const std::vector<std::string>& columns, const Row& row);
+    void printRows(const std::vector<std::string>& columns, const RowList& rows);
     void executeCreate(const CreateCommand& command);
     void executeDrop(const DropCommand& command);
-    void executeInsert(const InsertCommand& command);
-    void executeUpdate(const UpdateCommand& command);
-    void executeDelete(const DeleteCommand& command);
+    void executeInsert(const InsertCommand& command, const Plan& plan);
+    void executeUpdate(const UpdateCommand& command, const Predicate& predicate);
+    void executeDelete(const DeleteCommand& command, const Predicate& predicate);
     void executeAlter(const AlterCommand& command);
     void executeSave(const SaveCommand& command);
     void executeLoad(const LoadCommand& command);
     void executeShow(const ShowCommand& command);
     void executeHelp(const HelpCommand& command);
-
-    bool evaluateWhereCondition(const Row& row, const std::string& where_clause);
+    void executeTransaction(const TransactionCommand& command);
 
 public:
-    explicit Executor(Database& database) : database_(database) {}
+    explicit Executor(Database& database, ResultSink& sink = stdoutSink()) : database_(database), sink_(sink) {}
 
     bool execute(const std::unique_ptr<Command>& command);
+    // plan is one made earlier for this command (prepared statements, plan cache), nullptr plans it now
+    bool execute(const Command& command, const Plan* plan);
+
+    // between BEGIN and COMMIT or ROLLBACK. the caller keeps the transaction's latches (see Latch.hpp)
+    bool inTransaction() const;
+    // drops everything written since BEGIN, does nothing without an open transaction
+    void rollbackTransaction();
+
+    // compiles the WHERE of a SELECT, UPDATE or DELETE, picks the access path of a SELECT and
+    // expands * and default INSERT columns from the tables in database
+    static Plan plan(const Command& command, const Database& database);
 };
@@ -0,0 +1,191 @@
+#include <stdexcept>
+#include <unordered_map>
+#include <fmt/format.h>
+
+#include "Join.hpp"
+#include "Table.hpp"
+
+auto ColumnResolver::tryResolve(const std::string& ref) const -> std::optional<Resolved> {
+    auto dot = ref.find('.');
+    if (dot != std::string::npos) {
+        auto qualifier = ref.substr(0, dot);
+        auto column = ref.substr(dot + 1);
+        for (size_t i = 0; i < inputs_.size(); i++) {
+            if (inputs_[i].name == qualifier && inputs_[i].table->hasColumn(column)) {
+                return Resolved{i, &inputs_[i].table->getColumn(column), ref};
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Resolved> found;
+    for (size_t i = 0; i < inputs_.size(); i++) {
+        if (!inputs_[i].table->hasColumn(ref)) continue;
+        if (found) {
+            throw std::runtime_error(fmt::format("column reference '{}' is ambiguous", ref));
+        }
+        found = Resolved{i, &inputs_[i].table->getColumn(ref), fmt::format("{}.{}", inputs_[i].name, ref)};
+    }
+    return found;
+}
+
+auto ColumnResolver::resolve(const std::string& ref) const -> Resolved {
+    auto resolved = tryResolve(ref);
+    if (!resolved) {
+        throw std::runtime_error(fmt::format("column '{}' doesnt exist", ref));
+    }
+    return *resolved;
+}
+
+auto ColumnResolver::getInputs() const -> const std::vector<JoinInput>& {
+    return inputs_;
+}
+
+auto ColumnResolver::qualify(size_t input, const Row& row) const -> Row {
+    const auto& name = inputs_[input].name;
+    Row out;
+    // by the table's columns, a stored row may keep its values under older names
+    for (const auto& column : inputs_[input].table->getColumns()) {
+        const auto& col = column.getName();
+        const Value* found = row.find(col);
+        if (!found) continue;
+        const Value& value = *found;
+        out.setValue(fmt::format("{}.{}", name, col), value);
+
+        bool unique = true;
+        for (size_t i = 0; i < inputs_.size() && unique; i++) {
+            if (i != input && inputs_[i].table->hasColumn(col)) unique = false;
+        }
+        if (unique) out.setValue(col, value);
+    }
+    return out;
+}
+
+auto HashJoin::concat(const Row& a, const Row& b) -> Row {
+    Row out = a;
+    for (const auto& [col, value] : b.getValues()) {
+        out.setValue(col, value);
+    }
+    return out;
+}
+
+// key of a row, nullopt when any key column is NULL or missing
+static auto joinKey(const Row& row, const std::vector<std::string>& keys) -> std::optional<CompositeKey> {
+    CompositeKey key;
+    key.reserve(keys.size());
+    for (const auto& col : keys) {
+        if (!row.hasColumn(col)) return std::nullopt;
+        const auto& v = row.getValue(col);
+        if (v.isNull()) return std::nullopt;
+        key.push_back(v);
+    }
+    return key;
+}
+
+auto HashJoin::join(const RowList& left, const RowList& right,
+                    const std::vector<std::string>& left_keys,
+                    const std::vector<std::string>& right_keys,
+                    bool left_unique, bool right_unique) -> RowList {
+    if (left_keys.size() != right_keys.size() || left_keys.empty()) {
+        throw std::runtime_error("hash join needs the same number of keys on both sides");
+    }
+
+    bool build_left = left.size() <= right.size();
+    const auto& build = build_left ? left : right;
+    const auto& probe = build_left ? right : left;
+    const auto& build_keys = build_left ? left_keys : right_keys;
+    const auto& probe_keys = build_left ? right_keys : left_keys;
+    bool build_unique = build_left ? left_unique : right_unique;
+
+    // keep the left columns first in the output regardless of which side was built
+    auto emit = [&](RowList& out, const Row& build_row, const Row& probe_row) {
+        out.push_back(build_left ? concat(build_row, probe_row) : concat(probe_row, build_row));
+    };
+
+    RowList out;
+    if (build_unique) {
+        std::unordered_map<CompositeKey, size_t, CompositeKeyHash> ht;
+        ht.reserve(build.size());
+        for (size_t i = 0; i < build.size(); i++) {
+            if (auto key = joinKey(build[i], build_keys)) ht.emplace(std::move(*key), i);
+        }
+        out.reserve(probe.size());
+        for (const auto& row : probe) {
+            auto key = joinKey(row, probe_keys);
+            if (!key) continue;
+            auto it = ht.find(*key);
+            if (it != ht.end()) emit(out, build[it->second], row);
+        }
+    } else {
+        std::unordered_map<CompositeKey, std::vector<size_t>, CompositeKeyHash> ht;
+        ht.reserve(build.size());
+        for (size_t i = 0; i < build.size(); i++) {
+            if (auto key = joinKey(build[i], build_keys)) ht[std::move(*key)].push_back(i);
+        }
+        for (const auto& row : probe) {
+            auto key = joinKey(row, probe_keys);
+            if (!key) continue;
+            auto it = ht.find(*key);
+            if (it == ht.end()) continue;
+            for (auto idx : it->second) emit(out, build[idx], row);
+        }
+    }
+    return out;
+}
+
+auto HashJoin::crossJoin(const RowList& left, const RowList& right) -> RowList {
+    RowList out;
+    out.reserve(left.size() * right.size());
+    for (const auto& l : left) {
+        for (const auto& r : right) {
+            out.push_back(concat(l, r));
+        }
+    }
+    return out;
+}
+
+// key column of a row, nullptr when missing or NULL
+static auto mergeKey(const Row* row, const std::string& key) -> const Value* {
+    if (!row->hasColumn(key)) return nullptr;
+    const auto& v = row->getValue(key);
+    return v.isNull() ? nullptr : &v;
+}
+
+auto SortMergeJoin::join(const RowCursor& left, const RowCursor& right,
+                         const std::string& left_key, const std::string& right_key) -> RowList {
+    RowList out;
+    RowList run; // right rows sharing the current key
+    const Row* l = left();
+    const Row* r = right();
+
+    while (l && r) {
+        const Value* lk = mergeKey(l, left_key);
+        if (!lk) { l = left(); continue; }
+        const Value* rk = mergeKey(r, right_key);
+        if (!rk) { r = right(); continue; }
+
+        if (*lk < *rk) {
+            l = left();
+        } else if (*rk < *lk) {
+            r = right();
+        } else {
+            Value key = *rk;
+            run.clear();
+            while (r) {
+                rk = mergeKey(r, right_key);
+                if (!rk || *rk != key) break;
+                run.push_back(*r);
+                r = right();
+            }
+            while (l) {
+                lk = mergeKey(l, left_key);
+                if (!lk || *lk != key) break;
+                for (const auto& match : run) {
+                    out.push_back(HashJoin::concat(*l, match));
+                }
+                l = left();
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CommonTypes.hpp"
+#include "Row.hpp"
+#include "Value.hpp"
+
+// a table taking part in a multi-table SELECT, name is how the query refers to it
+struct JoinInput {
+    std::string name;
+    TablePtr table;
+};
+
+// maps column references ("col" or "table.col") to the input that owns them
+class ColumnResolver {
+public:
+    struct Resolved {
+        size_t input;
+        const Column* column;
+        std::string qualified; // always "table.col"
+    };
+
+private:
+    std::vector<JoinInput> inputs_;
+
+public:
+    explicit ColumnResolver(std::vector<JoinInput> inputs) : inputs_(std::move(inputs)) {}
+
+    std::optional<Resolved> tryResolve(const std::string& ref) const; // throws on ambiguous bare names
+    Resolved resolve(const std::string& ref) const; // throws if the column doesn't exist
+    const std::vector<JoinInput>& getInputs() const;
+
+    // copies a row of one input under "table.col" names, plus the bare name when it is unambiguous
+    Row qualify(size_t input, const Row& row) const;
+};
+
+// pull based input, returns nullptr once exhausted. the row stays valid until the next call
+using RowCursor = std::function<const Row*()>;
+
+class HashJoin {
+public:
+    // builds the hash table on the smaller input and probes it with the larger one,
+    // rows with a NULL key never match. *_unique tells that the keys of that side are
+    // known to be distinct (PK / UNIQUE), which lets the build side skip the match lists
+    static RowList join(const RowList& left, const RowList& right,
+                        const std::vector<std::string>& left_keys,
+                        const std::vector<std::string>& right_keys,
+                        bool left_unique = false, bool right_unique = false);
+
+    static RowList crossJoin(const RowList& left, const RowList& right);
+    static Row concat(const Row& a, const Row& b);
+};
+
+class SortMergeJoin {
+public:
+    // both inputs must be ordered ascending by their key and rows with a NULL key are skipped.
+    // there is no hash table: only the current run of equal keys of the right input is buffered,
+    // everything else streams through. the output is ordered by the key as well
+    static RowList join(const RowCursor& left, const RowCursor& right,
+                        const std::string& left_key, const std::string& right_key);
+};
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "Latch.hpp"
+#include "Commands.hpp"
+#include "Constraint.hpp"
+#include "Table.hpp"
+
+// lowercase name -> written, of the tables command writes or checks its foreign keys against.
+// a std::map walks them in the order every statement latches in.
+// SELECT and SAVE read a snapshot (see Mvcc.hpp) and need no table latches
+static auto latchedTables(const Database& database, const Command& command) -> std::map<std::string, bool> {
+    std::map<std::string, bool> tables;
+    auto add = [&](std::string name, bool write) {
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        tables[name] = tables[name] || write;
+    };
+
+    switch (command.getType()) {
+        case CommandType::INSERT: {
+            const auto& name = static_cast<const InsertCommand&>(command).getTableName();
+            add(name, true);
+            if (auto table = database.getTable(name)) {
+                for (const auto& constraint : table->getConstraintsOfType(ConstraintType::FOREIGN_KEY)) {
+                    add(static_cast<const ForeignKeyConstraint&>(*constraint).getRefTable(), false);
+                }
+            }
+            break;
+        }
+        case CommandType::UPDATE:
+            add(static_cast<const UpdateCommand&>(command).getTableName(), true);
+            break;
+        case CommandType::DELETE:
+            add(static_cast<const DeleteCommand&>(command).getTableName(), true);
+            break;
+        default:
+            break;
+    }
+    return tables;
+}
+
+StatementLatches::StatementLatches(Database& database)
+    : database_(database), catalog_shared_(database.catalogLatch()) {}
+
+StatementLatches::StatementLatches(Database& database, const Command& command) : database_(database) {
+    switch (command.getType()) {
+        case CommandType::CREATE:
+        case CommandType::DROP:
+        case CommandType::ALTER:
+        case CommandType::LOAD:
+            // nobody else holds a table latch without the catalog one, so this covers the tables too
+            catalog_exclusive_ = std::unique_lock(database.catalogLatch());
+            return;
+        default:
+            catalog_shared_ = std::shared_lock(database.catalogLatch());
+            lockTables(command);
+    }
+}
+
+auto StatementLatches::lockTables(const Command& command) -> void {
+    for (const auto& [name, write] : latchedTables(database_, command)) {
+        auto table = database_.getTable(name);
+        if (!table) continue; // executing the statement reports it
+        if (write) {
+            exclusive_.emplace_back(table->latch());
+        } else {
+            shared_.emplace_back(table->latch());
+        }
+    }
+}
+
+TransactionLatches::TransactionLatches(Database& database)
+    : database_(database), catalog_(database.catalogLatch()) {}
+
+auto TransactionLatches::lockTables(const Command& command) -> void {
+    for (const auto& [name, write] : latchedTables(database_, command)) {
+        if (tables_.count(name)) continue;
+        auto table = database_.getTable(name);
+        if (!table) continue;
+        std::unique_lock latch(table->latch(), LOCK_TIMEOUT);
+        if (!latch.owns_lock()) {
+            throw std::runtime_error(fmt::format("timed out waiting for table '{}'", table->getName()));
+        }
+        tables_.emplace(name, std::move(latch));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "Command.hpp"
+#include "Database.hpp"
+
+// the latches one statement holds while it runs. the catalog latch comes first, exclusive for
+// CREATE, DROP, ALTER and LOAD and shared for everything else, then the latches of the tables the
+// statement writes in name order: exclusive for the table it writes, shared for the tables an
+// INSERT checks its foreign keys against. everyone takes them in the same order, so an INSERT
+// checking its parent table and a writer of that parent can't end up waiting on each other.
+// SELECT and SAVE read a snapshot instead and only hold the catalog latch
+class StatementLatches {
+private:
+    Database& database_;
+    std::shared_lock<std::shared_mutex> catalog_shared_;
+    std::unique_lock<std::shared_mutex> catalog_exclusive_;
+    std::vector<std::shared_lock<std::shared_timed_mutex>> shared_;
+    std::vector<std::unique_lock<std::shared_timed_mutex>> exclusive_;
+
+public:
+    // only the catalog latch, shared. lockTables() adds the rest once the statement is known
+    explicit StatementLatches(Database& database);
+    // everything command needs
+    StatementLatches(Database& database, const Command& command);
+
+    StatementLatches(const StatementLatches&) = delete;
+    StatementLatches& operator=(const StatementLatches&) = delete;
+
+    // latches of the tables command writes or checks, needs the catalog latch held shared
+    void lockTables(const Command& command);
+};
+
+// the latches of an open transaction, held from BEGIN until COMMIT or ROLLBACK so nobody else
+// writes the tables it wrote in between. the catalog latch is shared for the whole transaction,
+// DDL waits for it to end. tables come one statement at a time and not in name order, so they are
+// all taken exclusive and a table held by someone else is waited for at most LOCK_TIMEOUT.
+// two transactions waiting on each other give up instead of hanging
+class TransactionLatches {
+public:
+    static constexpr std::chrono::seconds LOCK_TIMEOUT{5};
+
+private:
+    Database& database_;
+    std::shared_lock<std::shared_mutex> catalog_;
+    std::map<std::string, std::unique_lock<std::shared_timed_mutex>> tables_; // lowercase name
+
+public:
+    explicit TransactionLatches(Database& database);
+
+    TransactionLatches(const TransactionLatches&) = delete;
+    TransactionLatches& operator=(const TransactionLatches&) = delete;
+
+    // adds the latches of the tables command writes or checks. throws if one doesn't come free
+    // in time, the transaction has to be rolled back then
+    void lockTables(const Command& command);
+};
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+#include <fmt/format.h>
+
+#include "Lexer.hpp"
+
+struct KeywordEntry {
+    std::string_view name;
+    Keyword keyword;
+};
+
+// sorted by name for the binary search in lookupKeyword
+static constexpr std::array<KeywordEntry, 50> keywords = {{
+    {"ADD", Keyword::ADD},
+    {"ALTER", Keyword::ALTER},
+    {"AND", Keyword::AND},
+    {"AS", Keyword::AS},
+    {"ASC", Keyword::ASC},
+    {"BEGIN", Keyword::BEGIN},
+    {"BY", Keyword::BY},
+    {"COLUMN", Keyword::COLUMN},
+    {"COLUMNS", Keyword::COLUMNS},
+    {"COMMIT", Keyword::COMMIT},
+    {"CREATE", Keyword::CREATE},
+    {"DEFAULT", Keyword::DEFAULT},
+    {"DELETE", Keyword::DELETE},
+    {"DESC", Keyword::DESC},
+    {"DROP", Keyword::DROP},
+    {"EXECUTE", Keyword::EXECUTE},
+    {"FALSE", Keyword::FALSE},
+    {"FROM", Keyword::FROM},
+    {"GROUP", Keyword::GROUP},
+    {"HELP", Keyword::HELP},
+    {"IN", Keyword::IN},
+    {"INNER", Keyword::INNER},
+    {"INSERT", Keyword::INSERT},
+    {"INTO", Keyword::INTO},
+    {"IS", Keyword::IS},
+    {"JOIN", Keyword::JOIN},
+    {"KEY", Keyword::KEY},
+    {"LIMIT", Keyword::LIMIT},
+    {"LOAD", Keyword::LOAD},
+    {"NOT", Keyword::NOT},
+    {"NULL", Keyword::NULL_VALUE},
+    {"OFFSET", Keyword::OFFSET},
+    {"ON", Keyword::ON},
+    {"ORDER", Keyword::ORDER},
+    {"PREPARE", Keyword::PREPARE},
+    {"PRIMARY", Keyword::PRIMARY},
+    {"RENAME", Keyword::RENAME},
+    {"ROLLBACK", Keyword::ROLLBACK},
+    {"SAVE", Keyword::SAVE},
+    {"SELECT", Keyword::SELECT},
+    {"SET", Keyword::SET},
+    {"SHOW", Keyword::SHOW},
+    {"TABLE", Keyword::TABLE},
+    {"TABLES", Keyword::TABLES},
+    {"TO", Keyword::TO},
+    {"TRUE", Keyword::TRUE},
+    {"UNIQUE", Keyword::UNIQUE},
+    {"UPDATE", Keyword::UPDATE},
+    {"VALUES", Keyword::VALUES},
+    {"WHERE", Keyword::WHERE},
+}};
+
+static_assert(std::is_sorted(keywords.begin(), keywords.end(), [](const auto& a, const auto& b) {
+    return a.name < b.name;
+}), "keyword table must stay sorted");
+
+static constexpr size_t MAX_KEYWORD_LENGTH = 8;
+
+static constexpr auto toUpper(char c) -> char {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+auto iequals(std::string_view a, std::string_view b) -> bool {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (toUpper(a[i]) != toUpper(b[i])) return false;
+    }
+    return true;
+}
+
+auto lookupKeyword(std::string_view word) -> Keyword {
+    if (word.size() > MAX_KEYWORD_LENGTH) return Keyword::NONE;
+    // uppercase into a stack buffer, most words are rejected by the length check already
+    char buf[MAX_KEYWORD_LENGTH];
+    for (size_t i = 0; i < word.size(); i++) {
+        buf[i] = toUpper(word[i]);
+    }
+    std::string_view upper(buf, word.size());
+
+    auto it = std::lower_bound(keywords.begin(), keywords.end(), upper, [](const KeywordEntry& e, std::string_view w) {
+        return e.name < w;
+    });
+    return it != keywords.end() && it->name == upper ? it->keyword : Keyword::NONE;
+}
+
+auto Token::unquoted() const -> std::string_view {
+    if (kind == TokenKind::STRING) return text.substr(1, text.size() - 2);
+    return text;
+}
+
+static constexpr auto isSpace(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static constexpr auto isDigit(char c) -> bool {
+    return c >= '0' && c <= '9';
+}
+
+static constexpr auto isOperatorChar(char c) -> bool {
+    return c == '=' || c == '<' || c == '>' || c == '!';
+}
+
+static constexpr auto isPunctuation(char c) -> bool {
+    return c == ',' || c == '(' || c == ')' || c == ';';
+}
+
+// a word that starts like a number is lexed as one, from_chars decides if it really is
+static constexpr auto looksNumeric(std::string_view word) -> bool {
+    size_t i = (word[0] == '-' || word[0] == '+') ? 1 : 0;
+    if (i < word.size() && word[i] == '.') i++;
+    return i < word.size() && isDigit(word[i]);
+}
+
+auto Lexer::reset(std::string_view input) -> void {
+    input_ = input;
+    pos_ = 0;
+}
+
+auto Lexer::atEnd() const -> bool {
+    for (size_t i = pos_; i < input_.size(); i++) {
+        if (!isSpace(input_[i])) return false;
+    }
+    return true;
+}
+
+auto Lexer::peek() const -> Token {
+    Lexer copy = *this;
+    return copy.next();
+}
+
+auto Lexer::next() -> Token {
+    while (pos_ < input_.size() && isSpace(input_[pos_])) {
+        pos_++;
+    }
+    if (pos_ >= input_.size()) {
+        return Token{TokenKind::END, {}, Keyword::NONE, pos_};
+    }
+
+    size_t start = pos_;
+    char c = input_[pos_];
+
+    if (isOperatorChar(c)) {
+        pos_++;
+        if (pos_ < input_.size() && input_[pos_] == '=') pos_++;
+        return Token{TokenKind::OPERATOR, input_.substr(start, pos_ - start), Keyword::NONE, start};
+    }
+    if (isPunctuation(c)) {
+        pos_++;
+        return Token{TokenKind::OPERATOR, input_.substr(start, 1), Keyword::NONE, start};
+    }
+    if (c == '\'' || c == '"') {
+        auto end = input_.find(c, pos_ + 1);
+        if (end == std::string_view::npos) {
+            throw std::runtime_error(fmt::format("unterminated string starting at position {}", start));
+        }
+        pos_ = end + 1;
+        return Token{TokenKind::STRING, input_.substr(start, pos_ - start), Keyword::NONE, start};
+    }
+
+    // everything else runs until whitespace, punctuation, an operator or a quote,
+    // which keeps qualified names like t.col in one token
+    while (pos_ < input_.size()) {
+        char d = input_[pos_];
+        if (isSpace(d) || isPunctuation(d) || isOperatorChar(d) || d == '\'' || d == '"') break;
+        pos_++;
+    }
+    auto word = input_.substr(start, pos_ - start);
+
+    if (looksNumeric(word)) {
+        return Token{TokenKind::NUMBER, word, Keyword::NONE, start};
+    }
+    if (word.size() > 1 && word[0] == '$' &&
+        std::all_of(word.begin() + 1, word.end(), [](char d) { return isDigit(d); })) {
+        return Token{TokenKind::PARAMETER, word, Keyword::NONE, start};
+    }
+    if (word == "*") {
+        return Token{TokenKind::OPERATOR, word, Keyword::NONE, start};
+    }
+    auto keyword = lookupKeyword(word);
+    return Token{keyword == Keyword::NONE ? TokenKind::IDENTIFIER : TokenKind::KEYWORD, word, keyword, start};
+}
+
+auto isLiteral(const Token& token) -> bool {
+    return token.kind == TokenKind::NUMBER || token.kind == TokenKind::STRING ||
+        token.is(Keyword::TRUE) || token.is(Keyword::FALSE) || token.is(Keyword::NULL_VALUE);
+}
+
+auto parameterIndex(const Token& token) -> size_t {
+    size_t n = 0;
+    auto text = token.text.substr(1);
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), n);
+    if (token.kind != TokenKind::PARAMETER || ec != std::errc() || n == 0) {
+        throw std::runtime_error(fmt::format("invalid parameter '{}', parameters are numbered from $1", token.text));
+    }
+    return n - 1;
+}
+
+auto tokenToValue(const Token& token) -> Value {
+    switch (token.kind) {
+        case TokenKind::STRING:
+            return Value(std::string(token.unquoted()));
+        case TokenKind::NUMBER: {
+            auto text = token.text;
+            if (text.front() == '+') text.remove_prefix(1); // from_chars doesn't take a plus sign
+            const char* first = text.data();
+            const char* last = text.data() + text.size();
+
+            if (text.find_first_of(".eE") == std::string_view::npos) {
+                int v;
+                auto [ptr, ec] = std::from_chars(first, last, v);
+                if (ec == std::errc::result_out_of_range) {
+                    throw std::runtime_error(fmt::format("integer out of range: {}", token.text));
+                }
+                if (ec == std::errc() && ptr == last) return Value(v);
+            } else {
+                double v;
+                auto [ptr, ec] = std::from_chars(first, last, v);
+                if (ec == std::errc() && ptr == last) return Value(v);
+            }
+            throw std::runtime_error(fmt::format("invalid number: {}", token.text));
+        }
+        case TokenKind::PARAMETER:
+            throw std::runtime_error(fmt::format("parameter {} is only allowed in a prepared statement", token.text));
+        case TokenKind::KEYWORD:
+            if (token.is(Keyword::TRUE)) return Value(true);
+            if (token.is(Keyword::FALSE)) return Value(false);
+            if (token.is(Keyword::NULL_VALUE)) return Value::Null();
+            break;
+        default:
+            break;
+    }
+    throw std::runtime_error(fmt::format("expected a value, got '{}'", token.text));
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "Value.hpp"
+
+enum class TokenKind {
+    END,
+    IDENTIFIER,
+    KEYWORD,
+    NUMBER,
+    STRING,
+    OPERATOR, // comparison operators, punctuation and *
+    PARAMETER, // $1, $2... in prepared statements
+};
+
+enum class Keyword : uint8_t {
+    NONE,
+    SELECT,
+    FROM,
+    WHERE,
+    GROUP,
+    ORDER,
+    BY,
+    ASC,
+    DESC,
+    LIMIT,
+    OFFSET,
+    AND,
+    IN,
+    IS,
+    JOIN,
+    INNER,
+    ON,
+    CREATE,
+    TABLE,
+    INSERT,
+    INTO,
+    VALUES,
+    UPDATE,
+    SET,
+    DELETE,
+    DROP,
+    ALTER,
+    ADD,
+    COLUMN,
+    RENAME,
+    TO,
+    SHOW,
+    TABLES,
+    COLUMNS,
+    SAVE,
+    LOAD,
+    HELP,
+    PREPARE,
+    EXECUTE,
+    AS,
+    NOT,
+    NULL_VALUE,
+    PRIMARY,
+    KEY,
+    UNIQUE,
+    DEFAULT,
+    BEGIN,
+    COMMIT,
+    ROLLBACK,
+    TRUE,
+    FALSE,
+};
+
+inline constexpr size_t KEYWORD_COUNT = static_cast<size_t>(Keyword::FALSE) + 1;
+
+struct Token {
+    TokenKind kind = TokenKind::END;
+    std::string_view text; // slice of the query, string literals keep their quotes
+    Keyword keyword = Keyword::NONE;
+    size_t pos = 0; // offset of the token in the query
+
+    bool empty() const { return kind == TokenKind::END; }
+    bool is(Keyword k) const { return keyword == k; }
+    bool is(std::string_view op) const { return kind == TokenKind::OPERATOR && text == op; }
+    std::string_view unquoted() const; // string literal without the quotes, other tokens as is
+};
+
+// case-insensitive, allocation free. NONE if the word isn't a keyword
+Keyword lookupKeyword(std::string_view word);
+bool iequals(std::string_view a, std::string_view b);
+
+// NUMBER, STRING, TRUE/FALSE and NULL tokens as a Value, numbers go through std::from_chars
+Value tokenToValue(const Token& token);
+bool isLiteral(const Token& token);
+size_t parameterIndex(const Token& token); // 0 for $1
+
+// single pass tokenizer over a query that outlives it, tokens are views into the query
+class Lexer {
+private:
+    std::string_view input_;
+    size_t pos_ = 0;
+
+public:
+    Lexer() = default;
+    explicit Lexer(std::string_view input) : input_(input) {}
+
+    void reset(std::string_view input);
+    Token next();
+    Token peek() const;
+
+    size_t position() const { return pos_; }
+    void seek(size_t pos) { pos_ = pos; } // back to a position() from earlier
+    bool atEnd() const; // nothing but whitespace left
+};
@@ -0,0 +1,77 @@
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "Memory.hpp"
+
+static std::atomic<size_t> in_use{0};
+
+auto memoryAllocated(size_t bytes) -> void {
+    in_use.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+auto memoryFreed(size_t bytes) -> void {
+    in_use.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+auto memoryInUse() -> size_t {
+    return in_use.load(std::memory_order_relaxed);
+}
+
+auto parseByteSize(std::string_view s) -> std::optional<size_t> {
+    size_t value = 0;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec != std::errc()) return std::nullopt;
+
+    std::string_view suffix(ptr, s.data() + s.size() - ptr);
+    if (suffix == "K" || suffix == "k") value <<= 10;
+    else if (suffix == "M" || suffix == "m") value <<= 20;
+    else if (suffix == "G" || suffix == "g") value <<= 30;
+    else if (!suffix.empty()) return std::nullopt;
+    return value;
+}
+
+auto memoryLimit() -> size_t {
+    static const size_t limit = [] {
+        const char* env = std::getenv("DB_MEMORY_LIMIT");
+        return env ? parseByteSize(env).value_or(0) : 0;
+    }();
+    return limit;
+}
+
+auto overMemoryLimit() -> bool {
+    size_t limit = memoryLimit();
+    return limit != 0 && memoryInUse() > limit;
+}
+
+auto checkMemoryLimit() -> void {
+    if (overMemoryLimit()) {
+        throw std::runtime_error(fmt::format("memory limit of {} bytes reached, {} bytes in use",
+            memoryLimit(), memoryInUse()));
+    }
+}
+
+auto MemoryCharge::add(size_t bytes) -> void {
+    bytes_ += bytes;
+    memoryAllocated(bytes);
+}
+
+auto MemoryCharge::set(size_t bytes) -> void {
+    if (bytes > bytes_) memoryAllocated(bytes - bytes_);
+    else memoryFreed(bytes_ - bytes);
+    bytes_ = bytes;
+}
+
+auto CountingResource::do_allocate(size_t bytes, size_t alignment) -> void* {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    memoryAllocated(bytes);
+    return p;
+}
+
+auto CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) -> void {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    allocated_.fetch_sub(bytes, std::memory_order_relaxed);
+    memoryFreed(bytes);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// memory accounting. tables and statements count what they allocate as they go: row arenas,
+// versions written by UPDATE, chunk bitmaps, string dictionaries and sort buffers all add to
+// one process wide total, which SHOW MEMORY reports and the memory limit is checked against
+
+void memoryAllocated(size_t bytes);
+void memoryFreed(size_t bytes);
+size_t memoryInUse(); // the process wide total
+
+// DB_MEMORY_LIMIT env var (bytes, K/M/G suffix allowed), 0 if there is none
+size_t memoryLimit();
+bool overMemoryLimit();
+// throws once the total is past the limit. called before work that would add to it, a write is
+// rejected while a sort spills instead (see ExternalSort)
+void checkMemoryLimit();
+
+// "64M" -> 64 << 20, nullopt if s isn't a size
+std::optional<size_t> parseByteSize(std::string_view s);
+
+// bytes one owner holds, in the process total for as long as it lives. not thread safe, for
+// things with a single writer
+class MemoryCharge {
+private:
+    size_t bytes_ = 0;
+
+public:
+    MemoryCharge() = default;
+    MemoryCharge(MemoryCharge&& other) noexcept : bytes_(std::exchange(other.bytes_, 0)) {}
+    MemoryCharge& operator=(MemoryCharge&& other) noexcept {
+        if (this != &other) {
+            release();
+            bytes_ = std::exchange(other.bytes_, 0);
+        }
+        return *this;
+    }
+    ~MemoryCharge() { release(); }
+
+    void add(size_t bytes);
+    void set(size_t bytes); // the owner holds bytes now
+    void release() { set(0); }
+    size_t bytes() const { return bytes_; }
+};
+
+// the default heap, counting what it hands out. for memory that can be freed by any thread
+class CountingResource : public std::pmr::memory_resource {
+private:
+    std::atomic<size_t> allocated_ = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    size_t allocated() const { return allocated_.load(std::memory_order_relaxed); } // bytes not freed yet
+};
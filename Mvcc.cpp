@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#include "Mvcc.hpp"
+#include "Column.hpp"
+
+auto VersionClock::open() -> uint64_t {
+    std::lock_guard lock(snapshots_mutex_);
+    // read under the mutex, horizon() can't miss a snapshot that is just being opened
+    uint64_t timestamp = committed_.load(std::memory_order_acquire);
+    open_.insert(timestamp);
+    return timestamp;
+}
+
+auto VersionClock::close(uint64_t timestamp) -> void {
+    std::lock_guard lock(snapshots_mutex_);
+    open_.erase(open_.find(timestamp));
+}
+
+auto VersionClock::horizon() const -> uint64_t {
+    std::lock_guard lock(snapshots_mutex_);
+    return open_.empty() ? committed_.load(std::memory_order_acquire) : *open_.begin();
+}
+
+auto VersionClock::commit(const std::function<void(uint64_t)>& stamp) -> uint64_t {
+    std::lock_guard lock(commit_mutex_);
+    uint64_t timestamp = committed_.load(std::memory_order_relaxed) + 1;
+    stamp(timestamp);
+    committed_.store(timestamp, std::memory_order_release); // snapshots from here on see the stamped versions
+    return timestamp;
+}
+
+auto VersionClock::committed() const -> uint64_t {
+    return committed_.load(std::memory_order_acquire);
+}
+
+auto RowVersion::visible(uint64_t timestamp) const -> const Row* {
+    const RowVersion* version = this;
+    while (version && version->begin.load(std::memory_order_acquire) > timestamp) {
+        version = version->older.load(std::memory_order_acquire);
+    }
+    return version && !version->deleted ? &version->row : nullptr;
+}
+
+auto RowVersion::operator delete(RowVersion* version, std::destroying_delete_t) -> void {
+    bool in_arena = version->in_arena;
+    std::pmr::memory_resource* heap = version->row.getValues().get_allocator().resource();
+    version->~RowVersion();
+    if (!in_arena) heap->deallocate(version, sizeof(RowVersion), alignof(RowVersion));
+}
+
+auto RowChunk::newVersion(const Row& row) -> RowVersion* {
+    void* memory = arena.allocate(sizeof(RowVersion), alignof(RowVersion));
+    return new (memory) RowVersion(row, arena);
+}
+
+auto RowChunk::heapVersion(const Row& row) -> RowVersion* {
+    void* memory = heap.allocate(sizeof(RowVersion), alignof(RowVersion));
+    return new (memory) RowVersion(row, heap);
+}
+
+auto ChunkColumn::boundOf(const Value& value, DataType type) -> std::optional<double> {
+    if (value.getType() != type) return std::nullopt;
+    switch (type) {
+        case DataType::INTEGER: return value.getUnchecked<int>();
+        case DataType::FLOAT: {
+            double v = value.getUnchecked<double>();
+            if (std::isnan(v)) return std::nullopt;
+            return v;
+        }
+        case DataType::BOOLEAN: return value.getUnchecked<bool>() ? 1.0 : 0.0;
+        case DataType::DATE: {
+            Date date = value.getUnchecked<Date>();
+            if (!date.ok()) return std::nullopt; // orders by its fields, not by its day
+            return std::chrono::sys_days(date).time_since_epoch().count();
+        }
+        case DataType::DATETIME:
+            return static_cast<double>(value.getUnchecked<DateTime>().time_since_epoch().count());
+        default:
+            return std::nullopt;
+    }
+}
+
+auto ChunkColumn::widen(const Value& value) -> void {
+    if (value.isNull()) {
+        nulls.store(true, std::memory_order_relaxed);
+        return;
+    }
+    auto bound = boundOf(value, type);
+    if (!bound) {
+        unbounded.store(true, std::memory_order_relaxed);
+        return;
+    }
+    // readers only look at versions committed before their snapshot, the commit orders these
+    // stores before their loads
+    if (!bounded.load(std::memory_order_relaxed)) {
+        min.store(*bound, std::memory_order_relaxed);
+        max.store(*bound, std::memory_order_relaxed);
+        bounded.store(true, std::memory_order_release);
+        return;
+    }
+    if (*bound < min.load(std::memory_order_relaxed)) min.store(*bound, std::memory_order_relaxed);
+    if (*bound > max.load(std::memory_order_relaxed)) max.store(*bound, std::memory_order_relaxed);
+}
+
+RowChunk::RowChunk(const ColumnList& table_columns) {
+    memory.add(sizeof(RowChunk));
+    for (const auto& column : table_columns) {
+        columns.push_back(std::make_unique<ChunkColumn>(column.getType()));
+    }
+}
+
+auto RowChunk::beginWrite() -> void {
+    if (changed.load(std::memory_order_relaxed) == VersionClock::UNCOMMITTED) return;
+    changed.store(VersionClock::UNCOMMITTED, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // before any of the changes
+}
+
+// true if the bit changed
+static auto setBit(SlotBits& bits, size_t index, bool on) -> bool {
+    auto& word = bits[index / 64];
+    uint64_t bit = uint64_t{1} << (index % 64);
+    uint64_t old = word.load(std::memory_order_relaxed);
+    word.store(on ? old | bit : old & ~bit, std::memory_order_relaxed); // only the writer stores
+    return ((old & bit) != 0) != on;
+}
+
+auto ChunkColumn::storedSize(const Value& value) -> size_t {
+    return sizeof(void*) + sizeof(size_t) + sizeof(std::pair<const std::string, Value>) + value.heapSize();
+}
+
+// only the writer stores
+static auto addTo(std::atomic<size_t>& counter, size_t add, size_t sub) -> void {
+    counter.store(counter.load(std::memory_order_relaxed) + add - sub, std::memory_order_relaxed);
+}
+
+auto RowChunk::setBits(size_t index, const Row* row, const Row* replaced, const ColumnList& table_columns) -> void {
+    if (setBit(live, index, row != nullptr)) {
+        rows += row ? 1 : -1;
+    }
+    for (size_t i = 0; i < table_columns.size() && i < columns.size(); i++) {
+        auto& column = *columns[i];
+        const Value* value = row ? row->find(table_columns[i].getName()) : nullptr;
+        setBit(column.valid, index, value && !value->isNull());
+        if (value) column.widen(*value);
+
+        const Value* old = replaced ? replaced->find(table_columns[i].getName()) : nullptr;
+        if (value || old) {
+            addTo(column.payload, value ? value->payloadSize() : 0, old ? old->payloadSize() : 0);
+            addTo(column.allocated, value ? ChunkColumn::storedSize(*value) : 0,
+                  old ? ChunkColumn::storedSize(*old) : 0);
+        }
+    }
+}
+
+RowChunk::~RowChunk() {
+    for (auto& slot : slots) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+auto RowView::get(RowId slot) const -> const Row* {
+    if (list_) return &(*list_)[slot];
+    const auto& chunk = (*chunks_)[slot / RowChunk::CAPACITY];
+    if (!chunk) return nullptr;
+    const RowVersion* newest = chunk->slots[slot % RowChunk::CAPACITY].load(std::memory_order_acquire);
+    return newest ? newest->visible(timestamp_) : nullptr;
+}
+
+auto RowView::bits(size_t chunk, const std::vector<size_t>& columns, SlotMask& live, std::vector<SlotMask>& valid) const -> bool {
+    if (!chunks_ || chunk >= chunks_->size() || !(*chunks_)[chunk]) return false;
+    const auto& c = *(*chunks_)[chunk];
+    // a seqlock: the writer marks the chunk before it touches a bit
+    uint64_t changed = c.changed.load(std::memory_order_acquire);
+    if (changed > timestamp_) return false;
+    valid.resize(columns.size());
+    for (size_t w = 0; w < RowChunk::WORDS; w++) {
+        live[w] = c.live[w].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i] >= c.columns.size()) return false;
+        for (size_t w = 0; w < RowChunk::WORDS; w++) {
+            valid[i][w] = c.columns[columns[i]]->valid[w].load(std::memory_order_relaxed);
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (c.changed.load(std::memory_order_relaxed) != changed) return false;
+
+    size_t first = chunk * RowChunk::CAPACITY;
+    size_t end = std::min(size_, first + RowChunk::CAPACITY);
+    for (size_t w = 0; w < RowChunk::WORDS; w++) {
+        size_t from = first + w * 64;
+        if (from >= end) {
+            live[w] = 0;
+        } else if (end - from < 64) {
+            live[w] &= (uint64_t{1} << (end - from)) - 1;
+        }
+    }
+    return true;
+}
+
+auto RowView::chunk(size_t index) const -> const RowChunk* {
+    return chunks_ && index < chunks_->size() ? (*chunks_)[index].get() : nullptr;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "Arena.hpp"
+#include "CommonTypes.hpp"
+#include "Memory.hpp"
+#include "Row.hpp"
+#include "data_types.hpp"
+
+// multi-version rows. a write never changes a row a reader might be looking at, it links a new
+// version in front of the old one. every write statement commits all of its versions under one
+// timestamp and a snapshot sees exactly what was committed at or before its own, so readers take
+// no table latches and writers don't wait for them
+
+// commit timestamps and the snapshots still reading
+class VersionClock {
+public:
+    static constexpr uint64_t UNCOMMITTED = UINT64_MAX; // begin of versions whose statement still runs
+
+private:
+    std::mutex commit_mutex_;             // commits take their timestamps one at a time
+    std::atomic<uint64_t> committed_ = 0; // newest committed timestamp
+    mutable std::mutex snapshots_mutex_;
+    std::multiset<uint64_t> open_;        // timestamps of open snapshots
+
+public:
+    uint64_t open(); // registers a snapshot at the newest commit
+    void close(uint64_t timestamp);
+    // oldest timestamp an open or a future snapshot reads at. a version replaced at or before it is garbage
+    uint64_t horizon() const;
+    // stamp gets the new timestamp and has to stamp every version the statement wrote with it
+    uint64_t commit(const std::function<void(uint64_t)>& stamp);
+    uint64_t committed() const;
+};
+
+// a consistent view of the whole database for one statement
+class Snapshot {
+public:
+    static constexpr uint64_t LATEST = VersionClock::UNCOMMITTED; // newest versions, uncommitted ones included
+
+private:
+    VersionClock* clock_ = nullptr;
+    uint64_t timestamp_ = LATEST;
+
+public:
+    // the newest version of every row, for a writer that holds the table's latch exclusively
+    Snapshot() = default;
+    // what is committed right now, stays readable until the snapshot is destroyed
+    explicit Snapshot(VersionClock& clock) : clock_(&clock), timestamp_(clock.open()) {}
+    ~Snapshot() {
+        if (clock_) clock_->close(timestamp_);
+    }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    uint64_t timestamp() const { return timestamp_; }
+};
+
+struct RowVersion {
+    Row row;
+    bool deleted = false; // left by DELETE, the row is empty
+    bool in_arena = false; // lives in its chunk's arena, which frees the memory
+    std::atomic<uint64_t> begin = VersionClock::UNCOMMITTED;
+    std::atomic<RowVersion*> older = nullptr; // the version this one replaced, until it is garbage collected
+
+    RowVersion() = default;
+    RowVersion(const Row& r, Arena& arena) : row(r, &arena), in_arena(true) {}
+    RowVersion(const Row& r, std::pmr::memory_resource& heap) : row(r, &heap) {}
+
+    // the version of this row a snapshot at timestamp sees, nullptr if there is none or it is deleted
+    const Row* visible(uint64_t timestamp) const;
+
+    // deleting a version in an arena only destroys it, any other goes back to the resource its row
+    // allocates from
+    void operator delete(RowVersion* version, std::destroying_delete_t);
+};
+
+// a row's slot, numbered across the table. it stays the row's for good: chunks never move and
+// a dropped one leaves a nullptr behind, so indexes can point at rows by it
+using RowId = uint64_t;
+
+// a bitmap over the slots of a chunk
+inline constexpr size_t CHUNK_WORDS = 1024 / 64;
+using SlotBits = std::array<std::atomic<uint64_t>, CHUNK_WORDS>;
+
+// what a chunk knows about one column of its table
+struct ChunkColumn {
+    DataType type;
+    SlotBits valid{}; // slots whose newest version has a value that isn't NULL here
+    // a zone map: bounds of the values any version in the chunk ever had here. they only widen,
+    // so they hold for every snapshot (see Predicate::mayMatch). INTEGER, FLOAT, BOOLEAN, DATE
+    // and DATETIME values are bounded as doubles, which they all fit exactly
+    std::atomic<bool> bounded = false;   // min and max are set
+    std::atomic<bool> unbounded = false; // held something bounds can't describe: a string, a NaN, another type
+    std::atomic<bool> nulls = false;     // held a NULL, which <= and >= match (see Value::operator<)
+    std::atomic<double> min = 0.0;
+    std::atomic<double> max = 0.0;
+    // what the newest versions hold here for SHOW MEMORY: Value::payloadSize() summed up, and an
+    // estimate of the bytes their values take in the rows (hash node and long string)
+    std::atomic<size_t> payload = 0;
+    std::atomic<size_t> allocated = 0;
+    MemoryCharge memory; // of this struct
+
+    explicit ChunkColumn(DataType t) : type(t) { memory.add(sizeof(ChunkColumn)); }
+
+    // where value of type goes between min and max, nullopt for one that has no place there
+    static std::optional<double> boundOf(const Value& value, DataType type);
+    void widen(const Value& value); // by a value of a version the writer stores
+    // what value takes in a row: its hash node and the long string it points at, the same
+    // whatever name the row keeps it under
+    static size_t storedSize(const Value& value);
+};
+
+// rows are appended into fixed size chunks, so appending never moves a row a reader holds
+struct RowChunk {
+    static constexpr size_t CAPACITY = 1024;
+    static constexpr size_t WORDS = CHUNK_WORDS;
+    static_assert(WORDS * 64 == CAPACITY);
+    using Bits = SlotBits;
+
+    // inserted rows and DELETE tombstones, freed in one go with the chunk. versions written by
+    // UPDATE come from the heap, a row updated over and over would grow the arena for good.
+    // only the table's writer allocates from it
+    Arena arena;
+    CountingResource heap; // where the versions written by UPDATE come from
+    // newest version of every row, owned by the chunk. replaced versions belong to the table and
+    // keep the chunk alive while they may be in its arena
+    std::array<std::atomic<RowVersion*>, CAPACITY> slots{};
+    std::atomic<size_t> size = 0; // slots in use, only the last chunk of a table grows
+
+    // validity bitmaps of the newest versions: live has the slots holding a row, the valid bits
+    // of columns[i] the ones whose row has a value that isn't NULL in the table's column i. the
+    // table keeps one per column, in column order. they only describe a snapshot that sees the
+    // newest version of every slot, RowView::bits checks that
+    Bits live{};
+    std::vector<std::unique_ptr<ChunkColumn>> columns;
+    size_t rows = 0; // set bits in live, only for the writer
+    // commit timestamp of the newest version here, UNCOMMITTED from the writer's first change
+    // until its commit. a reader that reads the same value before and after copying bits got
+    // bits that belong together
+    std::atomic<uint64_t> changed = VersionClock::UNCOMMITTED;
+
+    MemoryCharge memory; // of this struct
+
+    RowVersion* newVersion(const Row& row); // in the arena
+    RowVersion* heapVersion(const Row& row); // from heap
+    void beginWrite(); // before the writer changes a slot or its bits
+    // the bits of slot index from the version now there, row is nullptr for a deleted one. the
+    // bounds widen to its values. replaced is the row the slot held before, nullptr if none
+    void setBits(size_t index, const Row* row, const Row* replaced, const ColumnList& table_columns);
+
+    explicit RowChunk(const ColumnList& table_columns);
+    ~RowChunk();
+    RowChunk(const RowChunk&) = delete;
+    RowChunk& operator=(const RowChunk&) = delete;
+};
+
+// nullptr where a chunk whose rows are all gone was dropped, so slot numbers never change
+using RowChunkList = std::vector<std::shared_ptr<RowChunk>>;
+
+// the rows a statement reads: a table as one snapshot sees it, or rows the statement built itself.
+// slots are numbered across the whole table, get() skips the ones the snapshot doesn't see
+class RowView {
+private:
+    std::shared_ptr<const RowChunkList> chunks_;
+    const RowList* list_ = nullptr;
+    size_t size_ = 0;
+    uint64_t timestamp_ = Snapshot::LATEST;
+
+public:
+    RowView() = default;
+    explicit RowView(const RowList& rows) : list_(&rows), size_(rows.size()) {}
+    RowView(std::shared_ptr<const RowChunkList> chunks, size_t slots, uint64_t timestamp)
+        : chunks_(std::move(chunks)), size_(slots), timestamp_(timestamp) {}
+
+    size_t size() const { return size_; } // slots, visible or not
+    const Row* get(RowId slot) const;     // nullptr if the snapshot sees no row there
+    // chunk index of a table view, nullptr for a dropped one or a view of rows a statement built
+    const RowChunk* chunk(size_t index) const;
+
+    using SlotMask = std::array<uint64_t, RowChunk::WORDS>;
+    // the live bits of chunk (slots from chunk * CAPACITY on, none past size()) and the validity
+    // bits of columns, positions in the table, one mask each. false if this isn't a view of a
+    // table or its snapshot doesn't see the newest version of every slot in the chunk, then
+    // only the rows can tell
+    bool bits(size_t chunk, const std::vector<size_t>& columns, SlotMask& live, std::vector<SlotMask>& valid) const;
+
+    // walks the visible rows in slot order
+    class Iterator {
+    private:
+        const RowView* view_;
+        size_t slot_;
+        const Row* row_ = nullptr;
+
+        void skip() {
+            while (slot_ < view_->size() && !(row_ = view_->get(slot_))) slot_++;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row*;
+        using reference = const Row&;
+
+        Iterator(const RowView* view, size_t slot) : view_(view), slot_(slot) { skip(); }
+
+        const Row& operator*() const { return *row_; }
+        const Row* operator->() const { return row_; }
+        Iterator& operator++() {
+            slot_++;
+            skip();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return slot_ == other.slot_; }
+    };
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size_); }
+};
@@ -2,189 +2,318 @@
 #include "Commands.hpp"
 #include "Value.hpp"
 #include "Table.hpp"
+#include <charconv>
+#include <iterator>
 #include <fmt/core.h>
+#include <fmt/format.h>
+
+constinit const std::array<Parser::Handler, KEYWORD_COUNT> Parser::handlers_ = [] {
+    std::array<Handler, KEYWORD_COUNT> h{};
+    auto set = [&h](Keyword k, Handler handler) { h[static_cast<size_t>(k)] = handler; };
+    set(Keyword::SELECT, &Parser::handleSelect);
+    set(Keyword::FROM, &Parser::handleFrom);
+    set(Keyword::WHERE, &Parser::handleWhere);
+    set(Keyword::GROUP, &Parser::handleGroup);
+    set(Keyword::ORDER, &Parser::handleOrder);
+    set(Keyword::LIMIT, &Parser::handleLimit);
+    set(Keyword::OFFSET, &Parser::handleOffset);
+    set(Keyword::CREATE, &Parser::handleCreate);
+    set(Keyword::TABLE, &Parser::handleTable);
+    set(Keyword::INSERT, &Parser::handleInsert);
+    set(Keyword::INTO, &Parser::handleInto);
+    set(Keyword::VALUES, &Parser::handleValues);
+    set(Keyword::UPDATE, &Parser::handleUpdate);
+    set(Keyword::SET, &Parser::handleSet);
+    set(Keyword::DELETE, &Parser::handleDelete);
+    set(Keyword::DROP, &Parser::handleDrop);
+    set(Keyword::ALTER, &Parser::handleAlter);
+    set(Keyword::SHOW, &Parser::handleShow);
+    set(Keyword::SAVE, &Parser::handleSave);
+    set(Keyword::LOAD, &Parser::handleLoad);
+    set(Keyword::HELP, &Parser::handleHelp);
+    set(Keyword::PREPARE, &Parser::handlePrepare);
+    set(Keyword::EXECUTE, &Parser::handleExecute);
+    set(Keyword::BEGIN, &Parser::handleBegin);
+    set(Keyword::COMMIT, &Parser::handleCommit);
+    set(Keyword::ROLLBACK, &Parser::handleRollback);
+    return h;
+}();
+
+auto Parser::parse(const std::string& query, bool allow_parameters) -> std::unique_ptr<Command> {
+    query_ = query;
+    lexer_.reset(query_);
+    resetState();
 
-static auto isString(const std::string& value) -> bool {
-    return !value.empty() && (value.front() == '\'' || value.front() == '"');
+    while (true) {
+        auto tok = nextToken();
+        if (tok.empty()) break;
+
+        auto handler = handlers_[static_cast<size_t>(tok.keyword)];
+        if (!handler) break;
+        //https://stackoverflow.com/a/3114231
+        (this->*handler)();
+    }
+    if (state_.uses_parameters && !allow_parameters) {
+        throw std::runtime_error("parameters like $1 are only allowed in PREPARE");
+    }
+    return buildCommand();
 }
 
-static auto isBool(const std::string& value) -> bool {
-    return value == "true" || value == "false";
+auto Parser::nextToken() -> Token {
+    return lexer_.next();
 }
 
-static auto isDouble(const std::string& value) -> bool {
-    return value.find('.') != std::string::npos;
+auto Parser::isKeyword(const Token& token) const -> bool {
+    return handlers_[static_cast<size_t>(token.keyword)] != nullptr;
 }
 
-auto Parser::parse(const std::string& query) -> std::unique_ptr<Command> {
-    query_ = query;
-    pos_ = 0;
-    resetState();
+auto Parser::handleSelect() -> void {
+    state_.current_command = CommandType::SELECT;
+    state_.current_tables_names.clear(); 
+    state_.current_columns_names.clear(); 
 
-    while (pos_ < query_.length()) {
-        auto keyword = findNextKeyword();
-        if (keyword.empty()) break;
+    while (true) {
+        auto tok = nextToken();
+        if (tok.empty()) break;
+        if (tok.is(Keyword::FROM)) {
+            handleFrom();
+            break;
+        }
+        if (tok.is(",")) continue;
 
-        auto handler = handlers_.find(keyword);
-        if (handler != handlers_.end()) {
-            //handler->second(*this, keyword);
-            //https://stackoverflow.com/a/3114231
-            (this->*handler->second)();
+        if (auto expr = parseAggregate(tok)) {
+            state_.current_columns_names.push_back(expr->toString());
+            state_.current_aggregates.push_back(std::move(*expr));
+            continue;
         }
+        state_.current_columns_names.emplace_back(tok.text);
     }
-    return buildCommand();
 }
 
-auto Parser::skipWhitespace() -> void {
-    while (pos_ < query_.length() && std::isspace(query_[pos_])) {
-        pos_++;
+// aggregate call starting at tok, e.g. COUNT(*) or SUM(salary)
+auto Parser::parseAggregate(const Token& tok) -> std::optional<AggregateExpr> {
+    if (tok.kind != TokenKind::IDENTIFIER) return std::nullopt;
+    auto function = stringToAggregateFunction(std::string(tok.text));
+    if (!function) return std::nullopt;
+
+    if (!lexer_.peek().is("(")) {
+        return std::nullopt; // plain column that happens to be called e.g. "count"
+    }
+    nextToken();
+    auto arg = nextToken();
+    if (arg.empty() || arg.is(")")) {
+        throw std::runtime_error(fmt::format("missing argument for {}", tok.text));
+    }
+    if (!nextToken().is(")")) {
+        throw std::runtime_error(fmt::format("expected ')' after {} argument", tok.text));
     }
+    if (arg.is("*") && *function != AggregateFunction::COUNT) {
+        throw std::runtime_error(fmt::format("{}(*) is not supported", tok.text));
+    }
+    return AggregateExpr{*function, std::string(arg.text)};
 }
 
-static constexpr std::string delimiters = ",();";
-static constexpr std::string operators = "=<>!";
-
-auto Parser::findNextToken() -> std::string {
-    skipWhitespace();
+auto Parser::handleFrom() -> void {
+    // only process table names if we're in a SELECT command, otherwise won't work lmao
+    if (state_.current_command == CommandType::SELECT) {
+        while (true) {
+            auto saved_pos = lexer_.position();
+            auto tok = nextToken();
+            if (tok.empty() || tok.is(";")) break;
+
+            // WHERE, GROUP BY, ORDER BY, LIMIT... are left to the main parse loop
+            if (isKeyword(tok)) {
+                lexer_.seek(saved_pos);
+                break;
+            }
+            // a JOIN b ON a.x = b.y is an inner join, the ON conditions go into the WHERE
+            // conjunction where they are treated the same way as comma joins
+            if (tok.is(Keyword::ON)) {
+                parseConditions();
+                continue;
+            }
+            if (tok.is(",") || tok.is(Keyword::JOIN) || tok.is(Keyword::INNER)) continue;
 
-    if (pos_ >= query_.length()) {
-        return ""; // maybe throw an error instead?
+            state_.current_tables_names.emplace_back(tok.text);
+            state_.current_table_name = tok.text;
+        }
     }
+}
 
-    std::string token;
-    bool in_quotes = false;
+auto Parser::handleWhere() -> void {
+    parseConditions();
+}
 
-    // Special case for operators
-    char c = query_[pos_];
-    if (c == '=' || c == '<' || c == '>' || c == '!') {
-        token += c;
-        pos_++;
+// reads "col op value [AND col op value ...]" and appends it to the WHERE conjunction,
+// a condition can also be "col IN (value, ...)" or "col IS [NOT] NULL"
+auto Parser::parseConditions() -> void {
+    while (true) {
+        auto column = nextToken();
+        if (column.empty()) {
+            throw std::runtime_error("missing column name in WHERE clause");
+        }
 
-        if (pos_ < query_.length() && query_[pos_] == '=') {
-            token += '=';
-            pos_++;
+        auto op = nextToken();
+        if (op.empty()) {
+            throw std::runtime_error("missing operator in WHERE clause");
         }
-        return token;
-    }
-    
-    // Normal token parsing
-    while (pos_ < query_.length()) {
-        c = query_[pos_];
-
-        if (c == '\'' || c == '"') {
-            in_quotes = !in_quotes; // flip
-            token += c;
-        } else if (!in_quotes && (std::isspace(c) || delimiters.find(c) != std::string::npos)) {
-            if (!token.empty()) return token;
-            if (c != ' ' && c != '\t' && c != '\n') {
-                token = c;
-                pos_++;
-                return token;
+
+        if (op.is(Keyword::IN) || op.is(Keyword::IS)) {
+            if (op.is(Keyword::IN)) {
+                parseInList(column);
+            } else {
+                parseIsNull(column);
             }
-        } else if (!in_quotes && (c == '=' || c == '<' || c == '>' || c == '!') && !token.empty()) {
-            // If we encounter an operator and we already have a token, return the token first
-            return token;
-        } else {
-            token += c;
+            if (!lexer_.peek().is(Keyword::AND)) break;
+            nextToken();
+            continue;
+        }
+
+        auto value = nextToken();
+        if (value.empty()) {
+            throw std::runtime_error("missing value in WHERE clause");
+        }
+
+        // Validate operator
+        if (!op.is("=") && !op.is("!=") && !op.is("<") && !op.is(">") && !op.is("<=") && !op.is(">=")) {
+            throw std::runtime_error(fmt::format("unsupported operator in WHERE clause: {}", op.text));
+        }
+
+        if (value.kind == TokenKind::PARAMETER) {
+            state_.uses_parameters = true; // Predicate::parse picks up the slot
         }
-        pos_++;
+        if (!state_.where_clause.empty()) {
+            state_.where_clause += " AND ";
+        }
+        fmt::format_to(std::back_inserter(state_.where_clause), "{} {} {}", column.text, op.text, value.text);
+
+        if (!lexer_.peek().is(Keyword::AND)) break;
+        nextToken();
     }
-    return token;
 }
 
-// this will always return capitalized
-auto Parser::findNextKeyword() -> std::string {
-    std::string tok = findNextToken();
-    if (tok.empty()) return "";
-    std::transform(tok.begin(), tok.end(), tok.begin(), [](unsigned char c){
-        return std::toupper(c);
-    });
-    return isKeyword(tok) ? tok : "";
+auto Parser::parseInList(const Token& column) -> void {
+    if (!nextToken().is("(")) {
+        throw std::runtime_error("expected ( after IN");
+    }
+    if (!state_.where_clause.empty()) {
+        state_.where_clause += " AND ";
+    }
+    fmt::format_to(std::back_inserter(state_.where_clause), "{} IN (", column.text);
+
+    size_t count = 0;
+    while (true) {
+        auto value = nextToken();
+        if (!isLiteral(value) && value.kind != TokenKind::PARAMETER) {
+            throw std::runtime_error(fmt::format("expected a value in IN list, got: {}", value.text));
+        }
+        if (value.kind == TokenKind::PARAMETER) {
+            state_.uses_parameters = true;
+        }
+        if (count++ > 0) state_.where_clause += ", ";
+        state_.where_clause += value.text;
+
+        auto next = nextToken();
+        if (next.is(")")) break;
+        if (!next.is(",")) {
+            throw std::runtime_error("expected , or ) in IN list");
+        }
+    }
+    state_.where_clause += ')';
 }
 
-auto Parser::isKeyword(const std::string& token) const -> bool {
-    return handlers_.contains(token);
+auto Parser::parseIsNull(const Token& column) -> void {
+    auto next = nextToken();
+    bool negated = next.is(Keyword::NOT);
+    if (negated) next = nextToken();
+    if (!next.is(Keyword::NULL_VALUE)) {
+        throw std::runtime_error("expected NULL or NOT NULL after IS");
+    }
+    if (!state_.where_clause.empty()) {
+        state_.where_clause += " AND ";
+    }
+    fmt::format_to(std::back_inserter(state_.where_clause), "{} IS {}NULL", column.text, negated ? "NOT " : "");
 }
 
-auto Parser::handleSelect() -> void {
-    state_.current_command = CommandType::SELECT;
-    state_.current_tables_names.clear(); 
-    state_.current_columns_names.clear(); 
+auto Parser::handleGroup() -> void {
+    if (!nextToken().is(Keyword::BY)) {
+        throw std::runtime_error("expected BY after GROUP");
+    }
 
-    while (pos_ < query_.length()) {
-        auto tok = findNextToken();
-        if (tok.empty()) break;
-        if (tok == "FROM") {
-            handleFrom();
+    while (true) {
+        auto saved_pos = lexer_.position();
+        auto tok = nextToken();
+        if (tok.empty() || tok.is(";")) break;
+        if (tok.is(",")) continue;
+
+        if (isKeyword(tok)) {
+            lexer_.seek(saved_pos); // leave the next clause to the main parse loop
             break;
         }
-        if (tok != ",") {
-            state_.current_columns_names.push_back(tok);
-        }
+        state_.group_by.emplace_back(tok.text);
+    }
+
+    if (state_.group_by.empty()) {
+        throw std::runtime_error("missing column list in GROUP BY");
     }
 }
 
-auto Parser::handleFrom() -> void {
-    // only process table names if we're in a SELECT command, otherwise won't work lmao
-    if (state_.current_command == CommandType::SELECT) {
-        while (pos_ < query_.length()) {
-            auto tok = findNextToken();
-            if (tok.empty() || tok == ";") break;
-            // if WHERE is found, process the WHERE clause and then break
-            if (tok == "WHERE") {
-                handleWhere();
-                break;
-            }
-            if (tok != ",") {
-                state_.current_tables_names.push_back(tok);
-                state_.current_table_name = tok;
+auto Parser::handleOrder() -> void {
+    if (!nextToken().is(Keyword::BY)) {
+        throw std::runtime_error("expected BY after ORDER");
+    }
+
+    while (true) {
+        auto saved_pos = lexer_.position();
+        auto tok = nextToken();
+        if (tok.empty() || tok.is(";")) break;
+        if (tok.is(",")) continue;
+
+        if (tok.is(Keyword::ASC) || tok.is(Keyword::DESC)) {
+            if (state_.order_by.empty()) {
+                throw std::runtime_error(fmt::format("{} without a column in ORDER BY", tok.text));
             }
+            state_.order_by.back().descending = tok.is(Keyword::DESC);
+            continue;
+        }
+        if (isKeyword(tok)) {
+            lexer_.seek(saved_pos);
+            break;
         }
 
-        // if we have a * in the column list, replace it with all column names
-        if (!state_.current_tables_names.empty() && 
-            state_.current_columns_names.size() == 1 && 
-            state_.current_columns_names[0] == "*") {
-            fmt::print("Looking up table: {}\n", state_.current_table_name);
-            auto table = database_.getTable(state_.current_table_name);
-            if (table) {
-                fmt::print("Found table, getting columns\n");
-                state_.current_columns_names.clear();
-                for (const auto& col : table->getColumns()) {
-                    fmt::print("Adding column: {}\n", col.getName());
-                    state_.current_columns_names.push_back(col.getName());
-                }
-            } else {
-                throw std::runtime_error(fmt::format("table '{}' not found", state_.current_table_name));
-            }
+        // aggregates are ordered by under the output column name they get in the select list
+        if (auto expr = parseAggregate(tok)) {
+            state_.order_by.push_back({expr->toString()});
+        } else {
+            state_.order_by.push_back({std::string(tok.text)});
         }
     }
-}
 
-auto Parser::handleWhere() -> void {
-    std::string column_name = findNextToken();
-    if (column_name.empty()) {
-        throw std::runtime_error("missing column name in WHERE clause");
+    if (state_.order_by.empty()) {
+        throw std::runtime_error("missing column list in ORDER BY");
     }
+}
 
-    std::string operator_str = findNextToken();
-    if (operator_str.empty()) {
-        throw std::runtime_error("missing operator in WHERE clause");
+static auto parseCount(const Token& tok, const char* clause) -> size_t {
+    size_t count = 0;
+    auto [ptr, ec] = std::from_chars(tok.text.data(), tok.text.data() + tok.text.size(), count);
+    if (tok.kind != TokenKind::NUMBER || ec != std::errc() || ptr != tok.text.data() + tok.text.size()) {
+        throw std::runtime_error(fmt::format("expected a non-negative number after {}, got '{}'", clause, tok.text));
     }
+    return count;
+}
 
-    std::string value_str = findNextToken();
-    if (value_str.empty()) {
-        throw std::runtime_error("missing value in WHERE clause");
-    }
+auto Parser::handleLimit() -> void {
+    state_.limit = parseCount(nextToken(), "LIMIT");
 
-    // Validate operator
-    if (operator_str != "=" && operator_str != "!=" && 
-        operator_str != "<" && operator_str != ">" && 
-        operator_str != "<=" && operator_str != ">=") {
-        throw std::runtime_error(fmt::format("unsupported operator in WHERE clause: {}", operator_str));
+    if (lexer_.peek().is(Keyword::OFFSET)) {
+        nextToken();
+        state_.offset = parseCount(nextToken(), "OFFSET");
     }
+}
 
-    state_.where_clause = fmt::format("{} {} {}", column_name, operator_str, value_str);
+auto Parser::handleOffset() -> void {
+    state_.offset = parseCount(nextToken(), "OFFSET");
 }
 
 auto Parser::handleCreate() -> void {
@@ -193,7 +322,7 @@ auto Parser::handleCreate() -> void {
 
 auto Parser::handleTable() -> void {
     if (state_.current_command == CommandType::CREATE) {
-        state_.current_table_name = findNextToken();
+        state_.current_table_name = nextToken().text;
         
         // Check if table name is empty
         if (state_.current_table_name.empty()) {
@@ -201,31 +330,30 @@ auto Parser::handleTable() -> void {
         }
         
         // Expect opening parenthesis for column definitions
-        auto tok = findNextToken();
-        if (tok != "(") {
+        if (!nextToken().is("(")) {
             throw std::runtime_error("expected '(' after table name");
         }
 
         // Parse column definitions
-        while (pos_ < query_.length()) {
-            auto col_name = findNextToken();
-            if (col_name.empty()) break;
-            if (col_name == ")") break;
+        while (true) {
+            auto col_tok = nextToken();
+            if (col_tok.empty() || col_tok.is(")")) break;
+            std::string col_name(col_tok.text);
 
-            auto type_name = findNextToken();
+            auto type_name = nextToken().text;
             if (type_name.empty()) {
                 throw std::runtime_error("expected data type after column name");
             }
 
             // Convert type name to DataType
             DataType type;
-            if (type_name == "INT" || type_name == "INTEGER") {
+            if (iequals(type_name, "INT") || iequals(type_name, "INTEGER")) {
                 type = DataType::INTEGER;
-            } else if (type_name == "VARCHAR" || type_name == "STRING") {
+            } else if (iequals(type_name, "VARCHAR") || iequals(type_name, "STRING")) {
                 type = DataType::STRING;
-            } else if (type_name == "BOOLEAN") {
+            } else if (iequals(type_name, "BOOLEAN")) {
                 type = DataType::BOOLEAN;
-            } else if (type_name == "FLOAT" || type_name == "DOUBLE") {
+            } else if (iequals(type_name, "FLOAT") || iequals(type_name, "DOUBLE")) {
                 type = DataType::FLOAT;
             } else {
                 throw std::runtime_error(fmt::format("unsupported data type: {}", type_name));
@@ -234,95 +362,62 @@ auto Parser::handleTable() -> void {
             Column col(col_name, type);
             bool done = false;
             while (!done) {
-                auto constraint_tok = findNextToken();
+                auto saved_pos = lexer_.position();
+                auto constraint_tok = nextToken();
                 if (constraint_tok.empty()) {
                     done = true;
-                } else if (constraint_tok == ",") {
+                } else if (constraint_tok.is(",")) {
                     done = true;
-                } else if (constraint_tok == ")") {
+                } else if (constraint_tok.is(")")) {
                     // end of all column definitions
-                    pos_--; // push back the token so it's read again in the outer loop
+                    lexer_.seek(saved_pos); // push back the token so it's read again below
                     done = true;
-                } else {
-                    // parse constraint
-                    std::string upper_constraint = constraint_tok;
-                    std::transform(upper_constraint.begin(), upper_constraint.end(), 
-                                  upper_constraint.begin(), ::toupper);
-
-                    if (upper_constraint == "NOT" || upper_constraint == "NOT NULL") {
-                        // handle NOT NULL constraint
-                        if (upper_constraint == "NOT") {
-                            // look for NULL keyword
-                            auto null_tok = findNextToken();
-                            std::string upper_null = null_tok;
-                            std::transform(upper_null.begin(), upper_null.end(), 
-                                          upper_null.begin(), ::toupper);
-                            if (upper_null != "NULL") {
-                                throw std::runtime_error("expected NULL after NOT");
-                            }
-                        }
-                        auto constraint = std::make_shared<NotNullConstraint>(
-                            ConstraintType::NOT_NULL, 
-                            col_name + "_not_null", 
-                            col_name);
-                        col.addConstraint(constraint);
-                        state_.current_constraints.push_back(constraint);
-                    } else if (upper_constraint == "UNIQUE") {
-                        // handle UNIQUE constraint
-                        auto constraint = std::make_shared<UniqueConstraint>(
-                            col_name + "_unique", 
-                            std::vector<std::string>{col_name});
-                        col.addConstraint(constraint);
-                        state_.current_constraints.push_back(constraint);
-                    } else if (upper_constraint == "PRIMARY" || upper_constraint == "PRIMARY KEY" || upper_constraint == "PK") {
-                        // handle PRIMARY KEY constraint
-                        if (upper_constraint == "PRIMARY") {
-                            // look for KEY keyword
-                            auto key_tok = findNextToken();
-                            std::string upper_key = key_tok;
-                            std::transform(upper_key.begin(), upper_key.end(), 
-                                         upper_key.begin(), ::toupper);
-
-                            if (upper_key != "KEY") {
-                                throw std::runtime_error("expected KEY after PRIMARY");
-                            }
-                        }
-
-                        auto constraint = std::make_shared<PrimaryKeyConstraint>(
-                            col_name + "_pk", 
-                            std::vector<std::string>{col_name});
-                        col.addConstraint(constraint);
-                        state_.current_constraints.push_back(constraint);
-                    } else if (upper_constraint == "DEFAULT") {
-                        // handle DEFAULT value constraint
-                        auto value_tok = findNextToken();
-                        Value default_value;
-                        if (isString(value_tok)) {
-                            default_value = Value(value_tok.substr(1, value_tok.length() - 2));
-                        } else if (isBool(value_tok)) {
-                            default_value = Value(value_tok == "true");
-                        } else if (isDouble(value_tok)) {
-                            default_value = Value(std::stod(value_tok));
-                        } else {
-                            // assume integer
-                            default_value = Value(std::stoi(value_tok));
-                        }
-                        auto constraint = std::make_shared<DefaultConstraint>(
-                            col_name + "_default", 
-                            col_name, 
-                            default_value);
-                        col.addConstraint(constraint);
-                        state_.current_constraints.push_back(constraint);
-                    } else {
-                        throw std::runtime_error(fmt::format("unknown constraint: {}", constraint_tok));
+                } else if (constraint_tok.is(Keyword::NOT)) {
+                    // handle NOT NULL constraint
+                    if (!nextToken().is(Keyword::NULL_VALUE)) {
+                        throw std::runtime_error("expected NULL after NOT");
+                    }
+                    auto constraint = std::make_shared<NotNullConstraint>(
+                        ConstraintType::NOT_NULL, 
+                        col_name + "_not_null", 
+                        col_name);
+                    col.addConstraint(constraint);
+                    state_.current_constraints.push_back(constraint);
+                } else if (constraint_tok.is(Keyword::UNIQUE)) {
+                    // handle UNIQUE constraint
+                    auto constraint = std::make_shared<UniqueConstraint>(
+                        col_name + "_unique", 
+                        std::vector<std::string>{col_name});
+                    col.addConstraint(constraint);
+                    state_.current_constraints.push_back(constraint);
+                } else if (constraint_tok.is(Keyword::PRIMARY) || iequals(constraint_tok.text, "PK")) {
+                    // handle PRIMARY KEY constraint
+                    if (constraint_tok.is(Keyword::PRIMARY) && !nextToken().is(Keyword::KEY)) {
+                        throw std::runtime_error("expected KEY after PRIMARY");
                     }
+
+                    auto constraint = std::make_shared<PrimaryKeyConstraint>(
+                        col_name + "_pk", 
+                        std::vector<std::string>{col_name});
+                    col.addConstraint(constraint);
+                    state_.current_constraints.push_back(constraint);
+                } else if (constraint_tok.is(Keyword::DEFAULT)) {
+                    // handle DEFAULT value constraint
+                    auto constraint = std::make_shared<DefaultConstraint>(
+                        col_name + "_default", 
+                        col_name, 
+                        tokenToValue(nextToken()));
+                    col.addConstraint(constraint);
+                    state_.current_constraints.push_back(constraint);
+                } else {
+                    throw std::runtime_error(fmt::format("unknown constraint: {}", constraint_tok.text));
                 }
             }
             state_.current_columns_def.push_back(col);
 
             // if we ended on a ')', were doooone heeer
-            if (pos_ < query_.length() && query_[pos_] == ')') {
-                findNextToken(); // eat the ')' and break
+            if (lexer_.peek().is(")")) {
+                nextToken(); // eat the ')' and break
                 break;
             }
         }
@@ -335,19 +430,16 @@ auto Parser::handleInsert() -> void {
 
 auto Parser::handleInto() -> void {
     if (state_.current_command == CommandType::INSERT) {
-        state_.current_table_name = findNextToken();
+        state_.current_table_name = nextToken().text;
 
         // column names in parentheses
-        auto saved_pos = pos_;
-        auto tok = findNextToken();
-        if (tok != "(") {
-            pos_ = saved_pos; // backtrack if no column list
-        } else {
-            while (pos_ < query_.length()) {
-                tok = findNextToken();
-                if (tok == ")") break;
-                if (tok != ",") {
-                    state_.current_columns_names.push_back(tok);
+        if (lexer_.peek().is("(")) {
+            nextToken();
+            while (true) {
+                auto tok = nextToken();
+                if (tok.empty() || tok.is(")")) break;
+                if (!tok.is(",")) {
+                    state_.current_columns_names.emplace_back(tok.text);
                 }
             }
         }
@@ -360,66 +452,43 @@ auto Parser::handleValues() -> void{
     }
 
     // Skip the VALUES keyword
-    auto tok = findNextToken();
-    if (tok != "(") {
+    auto tok = nextToken();
+    if (!tok.is("(")) {
         throw std::runtime_error("expected '(' after VALUES");
     }
 
     auto value_sets = std::vector<std::vector<Value>>();
     auto current_set = std::vector<Value>();
 
-    // if no column names were specified, use all columns from the table
-    if (state_.current_columns_names.empty()) {
-        fmt::print("Looking up table: {}\n", state_.current_table_name);
-        auto table = database_.getTable(state_.current_table_name);
-        if (table) {
-            fmt::print("Found table, getting columns\n");
-            for (const auto& col : table->getColumns()) {
-                fmt::print("Adding column: {}\n", col.getName());
-                state_.current_columns_names.push_back(col.getName());
-            }
-            fmt::print("Total columns added: {}\n", state_.current_columns_names.size());
-        } else {
-            fmt::print("Table not found!\n");
-        }
-    }
-
-    while (pos_ < query_.length()) {
-        tok = findNextToken();
-        if (tok.empty()) break;
+    while (true) {
+        tok = nextToken();
+        if (tok.empty() || tok.is(";")) break;
 
-        if (tok == "(") {
+        if (tok.is("(")) {
             current_set.clear();
-        } else if (tok == ")") {
+        } else if (tok.is(")")) {
             if (!current_set.empty()) {
-                value_sets.push_back(current_set);
+                value_sets.push_back(std::move(current_set));
+                current_set.clear();
             }
-        } else if (tok == ",") {
+        } else if (tok.is(",")) {
             // skip commas, delete this later
+        } else if (tok.kind == TokenKind::PARAMETER) {
+            state_.uses_parameters = true;
+            state_.parameters.push_back({ParameterSlot::Kind::INSERT_VALUE, parameterIndex(tok),
+                                         value_sets.size(), current_set.size(), std::string()});
+            current_set.emplace_back(); // NULL until bound
         } else {
-            // parse the value
-            if (isString(tok)) {
-                current_set.push_back(Value(tok.substr(1, tok.length()-2)));
-            } else if (isBool(tok)) {
-                current_set.push_back(Value(tok == "true"));
-            } else if (isDouble(tok)) {
-                current_set.push_back(Value(std::stod(tok)));
-            } else {
-                current_set.push_back(Value(std::stoi(tok)));
-            }
-        }
-
-        if (tok == ";" || pos_ >= query_.length()) {
-            break;
+            current_set.push_back(tokenToValue(tok));
         }
     }
 
-    state_.current_value_sets = value_sets;
+    state_.current_value_sets = std::move(value_sets);
 }
 
 auto Parser::handleUpdate() -> void {
     state_.current_command = CommandType::UPDATE;
-    state_.current_table_name = findNextToken(); // table name after UPDATE
+    state_.current_table_name = nextToken().text; // table name after UPDATE
 }
 
 auto Parser::handleSet() -> void {
@@ -427,100 +496,62 @@ auto Parser::handleSet() -> void {
         throw std::runtime_error("SET found outside UPDATE statement!");
     }
 
-    auto in_quotes = false;
-    auto cur_val_s = std::string();
-    auto cur_col = std::string();
-    auto expecting_value = false;
-
-    auto append_val = [&](){
-        if (!cur_val_s.empty()) {
-            Value val;
-            if (isString(cur_val_s)) {
-                val = Value(cur_val_s.substr(1, cur_val_s.length()-2));
-            } else if (isBool(cur_val_s)) {
-                val = Value(cur_val_s == "true");
-            } else if (isDouble(cur_val_s)) {
-                val = Value(std::stod(cur_val_s));
-            } else {
-                val = Value(std::stoi(cur_val_s));
-            }
-            state_.current_values[cur_col] = val;
-            cur_val_s.clear();
-            cur_col.clear();
-            expecting_value = false;
-        }
-    };
-
-    while (pos_ < query_.length()) {
-        char c = query_[pos_];
-        if (c == '\'' || c == '"') {
-            in_quotes = !in_quotes;
-            cur_val_s += c;
-        } else if (c == '=' && !in_quotes && !expecting_value) {
-            expecting_value = true;
-        } else if (c == ',' && !in_quotes) {
-            append_val();
-        } else if (!std::isspace(c) || in_quotes) {
-            if (expecting_value) {
-                cur_val_s += c;
-            } else {
-                cur_col += c;
-            }
+    // col = value [, col = value ...] up to WHERE or the end
+    while (true) {
+        auto col = nextToken();
+        if (col.empty() || col.is(";")) break;
+        if (!nextToken().is("=")) {
+            throw std::runtime_error(fmt::format("expected '=' after '{}' in SET", col.text));
         }
-        pos_++;
-        // 'W' for 'W'HERE
-        if (!in_quotes && (pos_ >= query_.length() || query_[pos_] == ';' || query_[pos_] == 'W')) {
-            append_val();
-            break;
+        auto value = nextToken();
+        if (value.kind == TokenKind::PARAMETER) {
+            state_.uses_parameters = true;
+            state_.parameters.push_back({ParameterSlot::Kind::SET_VALUE, parameterIndex(value), 0, 0, std::string(col.text)});
+            state_.current_values[std::string(col.text)] = Value(); // NULL until bound
+        } else {
+            state_.current_values[std::string(col.text)] = tokenToValue(value);
         }
+
+        if (!lexer_.peek().is(",")) break;
+        nextToken();
     }
 }
 
 auto Parser::handleDelete() -> void {
     state_.current_command = CommandType::DELETE;
-    auto tok = findNextToken(); // skip FROM
-    if (tok == "FROM") {
-        state_.current_table_name = findNextToken(); // get table name after FROM
+    if (nextToken().is(Keyword::FROM)) {
+        state_.current_table_name = nextToken().text; // get table name after FROM
     }
 }
 
 auto Parser::handleDrop() -> void {
-    auto token = findNextToken();
-    if (token != "TABLE") {
+    if (!nextToken().is(Keyword::TABLE)) {
         throw std::runtime_error("expected TABLE after DROP");
     }
     
     state_.current_command = CommandType::DROP;
-    state_.current_table_name = findNextToken();
+    state_.current_table_name = nextToken().text;
 }
 
 auto Parser::handleAlter() -> void {
     state_.current_command = CommandType::ALTER;
-    auto token = findNextToken();
-    
-    if (token != "TABLE") {
+    if (!nextToken().is(Keyword::TABLE)) {
         throw std::runtime_error("expected TABLE after ALTER");
     }
     
-    state_.current_table_name = findNextToken();
+    state_.current_table_name = nextToken().text;
     if (state_.current_table_name.empty()) {
         throw std::runtime_error("table name cannot be empty");
     }
     
-    // Check if table exists
-    auto table = database_.getTable(state_.current_table_name);
-    if (!table) {
-        throw std::runtime_error(fmt::format("table '{}' does not exist", state_.current_table_name));
-    }
-    
-    auto action = findNextToken();
-    if (action == "ADD") {
-        std::string column_name = findNextToken();
+    auto action = nextToken();
+    if (action.is(Keyword::ADD)) {
+        std::string column_name(nextToken().text);
         if (column_name.empty()) {
             throw std::runtime_error("column name cannot be empty");
         }
         
-        std::string type_str = findNextToken();
+        std::string type_str(nextToken().text);
         if (type_str.empty()) {
             throw std::runtime_error("column type cannot be empty");
         }
@@ -532,10 +563,22 @@ auto Parser::handleAlter() -> void {
         } catch (const std::exception& e) {
             throw std::runtime_error(fmt::format("invalid data type: {}", type_str));
         }
-    } else if (action == "DROP") {
-        auto token = findNextToken();
-        if (token == "COLUMN") {
-            std::string column_name = findNextToken();
+
+        // rows already in the table read the default without being rewritten
+        if (lexer_.peek().is(Keyword::DEFAULT)) {
+            nextToken();
+            auto value = nextToken();
+            if (value.empty()) {
+                throw std::runtime_error("expected a value after DEFAULT");
+            }
+            state_.current_columns_def.back().addConstraint(std::make_shared<DefaultConstraint>(
+                column_name + "_default",
+                column_name,
+                tokenToValue(value)));
+        }
+    } else if (action.is(Keyword::DROP)) {
+        if (nextToken().is(Keyword::COLUMN)) {
+            std::string column_name(nextToken().text);
             if (column_name.empty()) {
                 throw std::runtime_error("column name cannot be empty");
             }
@@ -545,20 +588,18 @@ auto Parser::handleAlter() -> void {
         } else {
             throw std::runtime_error("expected COLUMN after DROP");
         }
-    } else if (action == "RENAME") {
-        auto token = findNextToken();
-        if (token == "COLUMN") {
-            std::string old_column_name = findNextToken();
+    } else if (action.is(Keyword::RENAME)) {
+        if (nextToken().is(Keyword::COLUMN)) {
+            std::string old_column_name(nextToken().text);
             if (old_column_name.empty()) {
                 throw std::runtime_error("old column name cannot be empty");
             }
             
-            token = findNextToken();
-            if (token != "TO") {
+            if (!nextToken().is(Keyword::TO)) {
                 throw std::runtime_error("expected TO after column name");
             }
             
-            std::string new_column_name = findNextToken();
+            std::string new_column_name(nextToken().text);
             if (new_column_name.empty()) {
                 throw std::runtime_error("new column name cannot be empty");
             }
@@ -569,62 +610,105 @@ auto Parser::handleAlter() -> void {
             throw std::runtime_error("expected COLUMN after RENAME");
         }
     } else {
-        throw std::runtime_error(fmt::format("unsupported ALTER action: {}", action));
+        throw std::runtime_error(fmt::format("unsupported ALTER action: {}", action.text));
     }
 }
 
 auto Parser::handleShow() -> void {
     state_.current_command = CommandType::SHOW;
-    auto tok = findNextToken();
-    if (tok == "TABLES") {
-        state_.current_command = CommandType::SHOW;
-    } else if (tok == "COLUMNS") {
-        tok = findNextToken(); // skip FROM
-        if (tok == "FROM") {
-            state_.current_table_name = findNextToken();
+    auto tok = nextToken();
+    if (tok.is(Keyword::COLUMNS)) {
+        if (nextToken().is(Keyword::FROM)) { // skip FROM
+            state_.current_table_name = nextToken().text;
         }
+    } else if (iequals(tok.text, "MEMORY")) {
+        state_.show_memory = true;
+        auto table = nextToken();
+        if (!table.empty() && !table.is(";")) state_.current_table_name = table.text;
     }
 }
 
 auto Parser::handleSave() -> void {
     state_.current_command = CommandType::SAVE;
-    std::string filename = findNextToken();
-
-    if (!filename.empty() && (filename.front() == '\'' || filename.front() == '"')) {
-        if (filename.size() >= 2 && (filename.back() == '\'' || filename.back() == '"')) {
-            // remove surrounding quotes
-            filename = filename.substr(1, filename.size() - 2);
-        }
-    }
-    state_.filename = filename;
+    state_.filename = nextToken().unquoted(); // quotes are optional
 }
 
 auto Parser::handleLoad() -> void {
     state_.current_command = CommandType::LOAD;
-    std::string filename = findNextToken();
-
-    if (!filename.empty() && (filename.front() == '\'' || filename.front() == '"')) {
-        if (filename.size() >= 2 && (filename.back() == '\'' || filename.back() == '"')) {
-            filename = filename.substr(1, filename.size() - 2);
-        }
-    }
-    
-    state_.filename = filename;
+    state_.filename = nextToken().unquoted();
 }
 
 auto Parser::handleHelp() -> void {
     state_.current_command = CommandType::HELP;
     // check for specific command to get help for
-    skipWhitespace();
-    if (pos_ < query_.length() && query_[pos_] != ';') {
-        state_.help_command = findNextToken();
+    auto tok = nextToken();
+    if (!tok.empty() && !tok.is(";")) {
+        state_.help_command = tok.text;
         std::transform(state_.help_command.begin(), state_.help_command.end(), 
                       state_.help_command.begin(), ::toupper);
     }
 }
 
+// PREPARE name AS statement, the statement itself is parsed when the session prepares it
+auto Parser::handlePrepare() -> void {
+    state_.current_command = CommandType::PREPARE;
+    auto name = nextToken();
+    if (name.kind != TokenKind::IDENTIFIER) {
+        throw std::runtime_error("expected a statement name after PREPARE");
+    }
+    if (!nextToken().is(Keyword::AS)) {
+        throw std::runtime_error(fmt::format("expected AS after PREPARE {}", name.text));
+    }
+    state_.statement_name = name.text;
+
+    if (lexer_.atEnd()) {
+        throw std::runtime_error(fmt::format("missing statement in PREPARE {}", name.text));
+    }
+    state_.statement_text = std::string_view(query_).substr(lexer_.position());
+    lexer_.seek(query_.size());
+}
+
+// EXECUTE name [(value, ...)]
+auto Parser::handleExecute() -> void {
+    state_.current_command = CommandType::EXECUTE;
+    auto name = nextToken();
+    if (name.kind != TokenKind::IDENTIFIER) {
+        throw std::runtime_error("expected a statement name after EXECUTE");
+    }
+    state_.statement_name = name.text;
+
+    if (!lexer_.peek().is("(")) return;
+    nextToken();
+    while (true) {
+        auto tok = nextToken();
+        if (tok.empty()) {
+            throw std::runtime_error(fmt::format("missing ')' in EXECUTE {}", name.text));
+        }
+        if (tok.is(")")) break;
+        if (tok.is(",")) continue;
+        state_.arguments.push_back(tokenToValue(tok));
+    }
+}
+
+auto Parser::handleBegin() -> void {
+    state_.current_command = CommandType::BEGIN;
+}
+
+auto Parser::handleCommit() -> void {
+    state_.current_command = CommandType::COMMIT;
+}
+
+auto Parser::handleRollback() -> void {
+    state_.current_command = CommandType::ROLLBACK;
+}
+
+auto Parser::getParameters() const -> const std::vector<ParameterSlot>& {
+    return state_.parameters;
+}
+
+// clears the buffers of the previous statement but keeps their capacity
 auto Parser::resetState() -> void {
-    state_ = ParseState();
+    state_.reset();
 }
 
 auto Parser::buildCommand() -> std::unique_ptr<Command> {
@@ -639,7 +723,12 @@ auto Parser::buildCommand() -> std::unique_ptr<Command> {
             return std::make_unique<SelectCommand>(
                 state_.current_columns_names,
                 state_.current_tables_names,
-                state_.where_clause
+                state_.where_clause,
+                state_.group_by,
+                state_.current_aggregates,
+                state_.order_by,
+                state_.limit,
+                state_.offset
             );
         case CommandType::CREATE:
             return std::make_unique<CreateCommand>(
@@ -671,13 +760,23 @@ auto Parser::buildCommand() -> std::unique_ptr<Command> {
         case CommandType::LOAD:
             return std::make_unique<LoadCommand>(state_.filename);
         case CommandType::SHOW:
-            if (state_.current_table_name.empty()) {
+            if (state_.show_memory) {
+                return std::make_unique<ShowCommand>(ShowCommand::ShowType::MEMORY, state_.current_table_name);
+            } else if (state_.current_table_name.empty()) {
                 return std::make_unique<ShowCommand>(ShowCommand::ShowType::TABLES);
             } else {
                 return std::make_unique<ShowCommand>(state_.current_table_name);
             }
         case CommandType::HELP:
             return std::make_unique<HelpCommand>(state_.help_command);
+        case CommandType::PREPARE:
+            return std::make_unique<PrepareCommand>(state_.statement_name, state_.statement_text);
+        case CommandType::EXECUTE:
+            return std::make_unique<ExecuteCommand>(state_.statement_name, state_.arguments);
+        case CommandType::BEGIN:
+        case CommandType::COMMIT:
+        case CommandType::ROLLBACK:
+            return std::make_unique<TransactionCommand>(state_.current_command);
         case CommandType::ALTER:
             if (!state_.current_columns_def.empty()) {
                 // ADD column case
@@ -1,20 +1,26 @@
 #pragma once
 
+#include <array>
 #include <unordered_map>
 
 #include "Column.hpp"
 #include "Command.hpp"
 #include "CommonTypes.hpp"
 #include "Value.hpp"
-#include "Database.hpp"
+#include "Aggregate.hpp"
+#include "Lexer.hpp"
+#include "Prepared.hpp"
+#include "Sort.hpp"
 
 class Parser {
 private:
     // https://stackoverflow.com/a/3114231
-    std::unordered_map<std::string, void(Parser::*)()> handlers_;
-    std::string query_;
-    size_t pos_;
-    Database& database_;
+    using Handler = void (Parser::*)();
+    // indexed by Keyword, nullptr for keywords that don't start a clause. built at compile time
+    static const std::array<Handler, KEYWORD_COUNT> handlers_;
+
+    std::string query_; // keeps its capacity between statements, like the state_ buffers
+    Lexer lexer_; // tokens are views into query_
 
     struct ParseState {
         CommandType current_command;
@@ -24,10 +30,21 @@ private:
         std::unordered_map<std::string, Value> current_values;
         std::vector<std::vector<Value>> current_value_sets;
         std::string where_clause;
+        std::vector<std::string> group_by;
+        std::vector<AggregateExpr> current_aggregates;
+        std::vector<OrderByItem> order_by;
+        std::optional<size_t> limit;
+        size_t offset = 0;
         std::vector<Column> current_columns_def;
         ConstraintList current_constraints;
         std::string filename; 
         std::string help_command; 
+        bool show_memory = false; // SHOW MEMORY, current_table_name is optional then
+        std::vector<ParameterSlot> parameters; // $n outside of WHERE
+        bool uses_parameters = false; // $n anywhere, WHERE included
+        std::string statement_name; // PREPARE / EXECUTE
+        std::string statement_text;
+        std::vector<Value> arguments;
 
         auto reset () -> void {
             current_command = CommandType::UNKNOWN; // by default
@@ -37,25 +54,42 @@ private:
             current_values.clear();
             current_value_sets.clear();
             where_clause.clear();
+            group_by.clear();
+            current_aggregates.clear();
+            order_by.clear();
+            limit.reset();
+            offset = 0;
             current_columns_def.clear();
             current_constraints.clear();
             filename.clear();
             help_command.clear();
+            show_memory = false;
+            parameters.clear();
+            uses_parameters = false;
+            statement_name.clear();
+            statement_text.clear();
+            arguments.clear();
         }
     } state_;
 
     void resetState();
 
-    std::string findNextKeyword();
-    std::string findNextToken();
-    void skipWhitespace();
-    bool isKeyword(const std::string& token) const;
+    Token nextToken();
+    bool isKeyword(const Token& token) const; // starts a clause, i.e. has a handler
 
     // all operations work on state, hence no return values
     // also, not sure if this is the correct form, kind of makes sense with out making an overkill
     void handleSelect();
     void handleFrom();
     void handleWhere();
+    void parseConditions();
+    void parseInList(const Token& column); // after "col IN"
+    void parseIsNull(const Token& column); // after "col IS"
+    void handleGroup();
+    void handleOrder();
+    void handleLimit();
+    void handleOffset();
+    std::optional<AggregateExpr> parseAggregate(const Token& tok);
     void handleCreate();
     void handleTable();
     void handleInsert();
@@ -70,28 +104,21 @@ private:
     void handleSave();
     void handleLoad();
     void handleHelp();
+    void handlePrepare();
+    void handleExecute();
+    void handleBegin();
+    void handleCommit();
+    void handleRollback();
 
     std::unique_ptr<Command> buildCommand();
 public:
-    explicit Parser(Database& database) : database_(database) {
-        handlers_["SELECT"] = &Parser::handleSelect;
-        handlers_["FROM"] = &Parser::handleFrom;
-        handlers_["WHERE"] = &Parser::handleWhere;
-        handlers_["CREATE"] = &Parser::handleCreate;
-        handlers_["TABLE"] = &Parser::handleTable;
-        handlers_["INSERT"] = &Parser::handleInsert;
-        handlers_["INTO"] = &Parser::handleInto;
-        handlers_["VALUES"] = &Parser::handleValues;
-        handlers_["UPDATE"] = &Parser::handleUpdate;
-        handlers_["SET"] = &Parser::handleSet;
-        handlers_["DELETE"] = &Parser::handleDelete;
-        handlers_["DROP"] = &Parser::handleDrop;
-        handlers_["ALTER"] = &Parser::handleAlter;
-        handlers_["SHOW"] = &Parser::handleShow;
-        handlers_["SAVE"] = &Parser::handleSave;
-        handlers_["LOAD"] = &Parser::handleLoad;
-        handlers_["HELP"] = &Parser::handleHelp;
-    }
-    std::unique_ptr<Command> parse(const std::string& query);
+    // cheap to construct, but meant to live as long as the session and parse every statement of it.
+    // never looks at the database, names are checked when the statement is planned, so a parser
+    // can run ahead of the executor on another thread
+    Parser() = default;
+    // $n placeholders are only accepted when parsing a statement to prepare
+    std::unique_ptr<Command> parse(const std::string& query, bool allow_parameters = false);
+    // $n placeholders outside of WHERE in the last parsed statement, for PreparedStatement
+    const std::vector<ParameterSlot>& getParameters() const;
 };
 
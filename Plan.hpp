@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Predicate.hpp"
+
+// how a SELECT reads its input, picked from the shape of the statement when it is planned
+enum class AccessPath {
+    SCAN,      // rows stream out in table order, LIMIT stops the scan early
+    TOP_K,     // ORDER BY ... LIMIT through a bounded heap
+    SORT,      // full ORDER BY through the external sort
+    AGGREGATE, // GROUP BY / aggregates through the hash aggregator
+    JOIN,      // several tables, join order and algorithms are picked from the data on every run
+};
+
+// everything decided about a statement before it runs. prepared statements and the plan cache
+// keep it next to the bound command so repeated executions skip parsing and planning
+struct Plan {
+    Predicate predicate; // compiled WHERE, empty for statements without one
+    AccessPath access_path = AccessPath::SCAN;
+    // SELECT output or INSERT target columns, with * and a missing INSERT column list expanded
+    // from the tables as they are when the statement is planned
+    std::vector<std::string> columns;
+};
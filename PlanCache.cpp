@@ -0,0 +1,93 @@
+#include "PlanCache.hpp"
+#include "Lexer.hpp"
+
+auto PlanCache::normalize(std::string_view query, std::string& key, std::vector<Value>& literals) -> bool {
+    key.clear();
+    literals.clear();
+
+    Lexer lexer(query);
+    Token token = lexer.next();
+    if (!token.is(Keyword::SELECT) && !token.is(Keyword::INSERT) &&
+        !token.is(Keyword::UPDATE) && !token.is(Keyword::DELETE)) {
+        return false;
+    }
+
+    Keyword previous = Keyword::NONE;
+    for (; !token.empty(); token = lexer.next()) {
+        if (token.kind == TokenKind::PARAMETER) return false;
+        if (!key.empty()) key += ' ';
+
+        bool count = previous == Keyword::LIMIT || previous == Keyword::OFFSET;
+        if (isLiteral(token) && !count) {
+            if (literals.size() == MAX_LITERALS) return false;
+            literals.push_back(tokenToValue(token));
+            key += '$';
+            key += std::to_string(literals.size());
+        } else if (token.kind == TokenKind::KEYWORD) {
+            for (char c : token.text) {
+                key += (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+            }
+        } else {
+            key += token.text;
+        }
+        previous = token.keyword;
+    }
+    return true;
+}
+
+auto PlanCache::lookup(const std::string& key, uint64_t schema_version,
+                       std::shared_ptr<PreparedStatement>& statement) -> bool {
+    if (schema_version != schema_version_) {
+        if (!entries_.empty()) invalidations_++;
+        clear();
+        schema_version_ = schema_version;
+    }
+
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    statement = it->second.statement;
+    return true;
+}
+
+auto PlanCache::insert(const std::string& key, std::shared_ptr<PreparedStatement> statement) -> void {
+    if (capacity_ == 0) return;
+
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.statement = std::move(statement);
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return;
+    }
+    if (entries_.size() >= capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{std::move(statement), lru_.begin()});
+}
+
+auto PlanCache::clear() -> void {
+    entries_.clear();
+    lru_.clear();
+}
+
+auto PlanCache::size() const -> size_t {
+    return entries_.size();
+}
+
+auto PlanCache::getHits() const -> size_t {
+    return hits_;
+}
+
+auto PlanCache::getMisses() const -> size_t {
+    return misses_;
+}
+
+auto PlanCache::getInvalidations() const -> size_t {
+    return invalidations_;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Prepared.hpp"
+#include "Value.hpp"
+
+// plans of ad-hoc statements keyed by their text with the literals taken out, so dashboards sending
+// the same query with different constants skip parsing and planning. the key is itself a statement
+// with $1, $2... where the literals were, on a miss it is prepared like PREPARE would
+class PlanCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+    static constexpr size_t MAX_LITERALS = 4096; // bigger bulk INSERTs aren't worth keeping around
+
+    explicit PlanCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+    // keywords uppercased, tokens separated by one space, literals replaced by $n and appended to
+    // literals. LIMIT and OFFSET counts stay in the key since the plan depends on them. false for
+    // anything but SELECT, INSERT, UPDATE and DELETE, and for statements that already use $n
+    static bool normalize(std::string_view query, std::string& key, std::vector<Value>& literals);
+
+    // true on a hit. a hit can hand back nullptr, meaning the statement was seen and can't be prepared.
+    // a schema version other than the one the entries were made under empties the cache first
+    bool lookup(const std::string& key, uint64_t schema_version, std::shared_ptr<PreparedStatement>& statement);
+    void insert(const std::string& key, std::shared_ptr<PreparedStatement> statement);
+    void clear();
+
+    size_t size() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+    size_t getInvalidations() const; // times the cache was emptied by a schema change
+
+private:
+    using LruList = std::list<std::string>;
+    struct Entry {
+        std::shared_ptr<PreparedStatement> statement;
+        LruList::iterator lru;
+    };
+
+    size_t capacity_;
+    std::unordered_map<std::string, Entry> entries_;
+    LruList lru_; // most recently used key first
+    uint64_t schema_version_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t invalidations_ = 0;
+};
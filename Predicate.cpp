@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <stdexcept>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include "Predicate.hpp"
+#include "Lexer.hpp"
+#include "Table.hpp"
+
+auto stringToCompareOp(const std::string& s) -> CompareOp {
+    if (s == "=") return CompareOp::EQ;
+    if (s == "!=") return CompareOp::NE;
+    if (s == "<") return CompareOp::LT;
+    if (s == ">") return CompareOp::GT;
+    if (s == "<=") return CompareOp::LE;
+    if (s == ">=") return CompareOp::GE;
+    throw std::runtime_error(fmt::format("unsupported operator in WHERE clause: {}", s));
+}
+
+auto compareOpToString(CompareOp op) -> std::string {
+    switch (op) {
+        case CompareOp::EQ: return "=";
+        case CompareOp::NE: return "!=";
+        case CompareOp::LT: return "<";
+        case CompareOp::GT: return ">";
+        case CompareOp::LE: return "<=";
+        case CompareOp::GE: return ">=";
+        case CompareOp::IN: return "IN";
+        case CompareOp::IS_NULL: return "IS NULL";
+        case CompareOp::IS_NOT_NULL: return "IS NOT NULL";
+    }
+    throw std::runtime_error("unknown compare operator");
+}
+
+auto Condition::evaluate(const Row& row) const -> bool {
+    const Value* lhs = row.find(column);
+    // a row without the column has NULL there
+    if (op == CompareOp::IS_NULL) return !lhs || lhs->isNull();
+    if (op == CompareOp::IS_NOT_NULL) return lhs && !lhs->isNull();
+    if (!lhs) {
+        return false; // column doesn't exist in this row
+    }
+    if (rhs_is_column) {
+        const Value* rhs = row.find(rhs_column);
+        if (!rhs) return false;
+        return kernel ? kernel(*lhs, *rhs) : compareValues(*lhs, op, *rhs);
+    }
+    if (op == CompareOp::IN) {
+        for (const auto& value : in_values) {
+            if (kernel ? kernel(*lhs, value) : *lhs == value) return true;
+        }
+        return false;
+    }
+    return kernel ? kernel(*lhs, rhs_value) : compareValues(*lhs, op, rhs_value);
+}
+
+auto Condition::chooseKernel(DataType column_type, DataType rhs_column_type) -> void {
+    if (op == CompareOp::IN) {
+        kernel = compareKernel(column_type, CompareOp::EQ);
+    } else if (rhs_is_column) {
+        kernel = rhs_column_type == column_type ? compareKernel(column_type, op) : nullptr;
+    } else {
+        // a literal of another type goes the generic way, which also keeps its errors
+        kernel = rhs_value.getType() == column_type ? compareKernel(column_type, op) : nullptr;
+    }
+}
+
+auto Condition::toString() const -> std::string {
+    if (op == CompareOp::IS_NULL || op == CompareOp::IS_NOT_NULL) {
+        return fmt::format("{} {}", column, compareOpToString(op));
+    }
+    if (op == CompareOp::IN) {
+        std::vector<std::string> list;
+        for (size_t i = 0; i < in_values.size(); i++) {
+            const auto& value = in_values[i];
+            if (in_params[i] && value.isNull()) {
+                list.push_back(fmt::format("${}", *in_params[i] + 1));
+            } else if (value.getType() == DataType::STRING) {
+                list.push_back(fmt::format("'{}'", value.toString()));
+            } else {
+                list.push_back(value.toString());
+            }
+        }
+        return fmt::format("{} IN ({})", column, fmt::join(list, ", "));
+    }
+    if (rhs_is_column) {
+        return fmt::format("{} {} {}", column, compareOpToString(op), rhs_column);
+    }
+    if (param && rhs_value.isNull()) {
+        return fmt::format("{} {} ${}", column, compareOpToString(op), *param + 1); // not bound yet
+    }
+    if (rhs_value.getType() == DataType::STRING) {
+        return fmt::format("{} {} '{}'", column, compareOpToString(op), rhs_value.toString());
+    }
+    return fmt::format("{} {} {}", column, compareOpToString(op), rhs_value.toString());
+}
+
+// "(value, ...)" after "col IN"
+static auto parseInList(const Token& column, Lexer& lexer) -> Condition {
+    Condition cond;
+    cond.column = column.text;
+    cond.op = CompareOp::IN;
+    if (!lexer.next().is("(")) {
+        throw std::runtime_error("expected ( after IN");
+    }
+    while (true) {
+        auto value = lexer.next();
+        if (value.kind == TokenKind::PARAMETER) {
+            cond.in_values.emplace_back();
+            cond.in_params.push_back(parameterIndex(value));
+        } else if (isLiteral(value)) {
+            try {
+                cond.in_values.push_back(tokenToValue(value));
+            } catch (const std::exception& e) {
+                throw std::runtime_error(fmt::format("error parsing value in WHERE clause: {}", e.what()));
+            }
+            cond.in_params.emplace_back();
+        } else {
+            throw std::runtime_error(fmt::format("expected a value in IN list, got: {}", value.text));
+        }
+        auto next = lexer.next();
+        if (next.is(")")) break;
+        if (!next.is(",")) {
+            throw std::runtime_error("expected , or ) in IN list");
+        }
+    }
+    return cond;
+}
+
+// "[NOT] NULL" after "col IS"
+static auto parseIsNull(const Token& column, Lexer& lexer) -> Condition {
+    Condition cond;
+    cond.column = column.text;
+    cond.op = CompareOp::IS_NULL;
+    auto next = lexer.next();
+    if (next.is(Keyword::NOT)) {
+        cond.op = CompareOp::IS_NOT_NULL;
+        next = lexer.next();
+    }
+    if (!next.is(Keyword::NULL_VALUE)) {
+        throw std::runtime_error("expected NULL or NOT NULL after IS");
+    }
+    return cond;
+}
+
+auto Predicate::parse(const std::string& where_clause) -> Predicate {
+    std::vector<Condition> conditions;
+    Lexer lexer(where_clause);
+
+    while (true) {
+        auto column = lexer.next();
+        if (column.empty()) break;
+        auto op = lexer.next();
+        if (op.is(Keyword::IN) || op.is(Keyword::IS)) {
+            if (op.is(Keyword::IN)) {
+                conditions.push_back(parseInList(column, lexer));
+            } else {
+                conditions.push_back(parseIsNull(column, lexer));
+            }
+            auto conj = lexer.next();
+            if (conj.empty()) break;
+            if (!conj.is(Keyword::AND)) {
+                throw std::runtime_error(fmt::format("expected AND in WHERE clause, got: {}", conj.text));
+            }
+            continue;
+        }
+        auto rhs = lexer.next();
+        if (op.kind != TokenKind::OPERATOR || rhs.empty()) {
+            throw std::runtime_error("invalid WHERE clause format");
+        }
+
+        Condition cond;
+        cond.column = column.text;
+        cond.op = stringToCompareOp(std::string(op.text));
+        if (rhs.kind == TokenKind::PARAMETER) {
+            cond.param = parameterIndex(rhs);
+        } else if (isLiteral(rhs)) {
+            try {
+                cond.rhs_value = tokenToValue(rhs);
+            } catch (const std::exception& e) {
+                throw std::runtime_error(fmt::format("error parsing value in WHERE clause: {}", e.what()));
+            }
+        } else {
+            cond.rhs_is_column = true;
+            cond.rhs_column = rhs.text;
+        }
+        conditions.push_back(std::move(cond));
+
+        auto conj = lexer.next();
+        if (conj.empty()) break;
+        if (!conj.is(Keyword::AND)) {
+            throw std::runtime_error(fmt::format("expected AND in WHERE clause, got: {}", conj.text));
+        }
+    }
+    return Predicate(std::move(conditions));
+}
+
+auto Predicate::parameterCount() const -> size_t {
+    size_t count = 0;
+    for (const auto& cond : conditions_) {
+        if (cond.param) count = std::max(count, *cond.param + 1);
+        for (const auto& param : cond.in_params) {
+            if (param) count = std::max(count, *param + 1);
+        }
+    }
+    return count;
+}
+
+auto Predicate::bind(const std::vector<Value>& params) -> void {
+    auto param_value = [&params](size_t index) -> const Value& {
+        if (index >= params.size()) {
+            throw std::runtime_error(fmt::format("no value for parameter ${}", index + 1));
+        }
+        return params[index];
+    };
+    for (auto& cond : conditions_) {
+        if (cond.param) cond.rhs_value = param_value(*cond.param);
+        for (size_t i = 0; i < cond.in_params.size(); i++) {
+            if (cond.in_params[i]) cond.in_values[i] = param_value(*cond.in_params[i]);
+        }
+    }
+}
+
+auto Predicate::boundTo(const Table& table) const -> Predicate {
+    Predicate bound(*this);
+    for (auto& cond : bound.conditions_) {
+        if (!table.hasColumn(cond.column)) continue; // matches no row
+        cond.column_index = table.getColumnIndex(cond.column);
+        if (cond.rhs_is_column) {
+            if (table.hasColumn(cond.rhs_column)) {
+                cond.chooseKernel(table.getColumn(cond.column).getType(), table.getColumn(cond.rhs_column).getType());
+            }
+            continue;
+        }
+        cond.chooseKernel(table.getColumn(cond.column).getType());
+
+        if (cond.op != CompareOp::EQ && cond.op != CompareOp::NE && cond.op != CompareOp::IN) continue;
+        const auto* dictionary = table.dictionary(cond.column);
+        if (!dictionary) continue;
+        cond.rhs_value = dictionary->lookup(cond.rhs_value);
+        for (auto& value : cond.in_values) {
+            value = dictionary->lookup(value);
+        }
+    }
+    return bound;
+}
+
+auto Predicate::candidates(const RowView& rows, size_t chunk, RowView::SlotMask& mask, bool& exact) const -> bool {
+    std::vector<size_t> columns;
+    bool only_null_tests = true;
+    for (const auto& cond : conditions_) {
+        bool null_test = cond.op == CompareOp::IS_NULL || cond.op == CompareOp::IS_NOT_NULL;
+        if (null_test && cond.column_index) {
+            columns.push_back(*cond.column_index);
+        } else {
+            only_null_tests = false;
+        }
+    }
+    std::vector<RowView::SlotMask> valid;
+    if (!rows.bits(chunk, columns, mask, valid)) return false;
+    exact = only_null_tests;
+
+    size_t i = 0;
+    for (const auto& cond : conditions_) {
+        if ((cond.op != CompareOp::IS_NULL && cond.op != CompareOp::IS_NOT_NULL) || !cond.column_index) continue;
+        const auto& bits = valid[i++];
+        for (size_t w = 0; w < mask.size(); w++) {
+            mask[w] &= cond.op == CompareOp::IS_NULL ? ~bits[w] : bits[w];
+        }
+    }
+    return true;
+}
+
+auto Predicate::mayMatch(const RowChunk& chunk) const -> bool {
+    for (const auto& cond : conditions_) {
+        if (!cond.column_index || cond.rhs_is_column || *cond.column_index >= chunk.columns.size()) continue;
+        if (cond.op == CompareOp::NE || cond.op == CompareOp::IS_NULL || cond.op == CompareOp::IS_NOT_NULL) continue;
+        const auto& column = *chunk.columns[*cond.column_index];
+        if (column.unbounded.load(std::memory_order_relaxed)) continue;
+        // NULL <= x and NULL >= x hold, everything else fails on NULL and on a missing value
+        if ((cond.op == CompareOp::LE || cond.op == CompareOp::GE) && column.nulls.load(std::memory_order_relaxed)) continue;
+
+        // literals of another type compare the generic way, which may throw, so they always run
+        std::vector<double> literals;
+        if (cond.op == CompareOp::IN) {
+            for (const auto& value : cond.in_values) {
+                auto bound = ChunkColumn::boundOf(value, column.type);
+                if (!bound) break;
+                literals.push_back(*bound);
+            }
+            if (literals.size() != cond.in_values.size()) continue;
+        } else {
+            auto bound = ChunkColumn::boundOf(cond.rhs_value, column.type);
+            if (!bound) continue;
+            literals.push_back(*bound);
+        }
+
+        if (!column.bounded.load(std::memory_order_acquire)) return false; // no value to match
+        double min = column.min.load(std::memory_order_relaxed);
+        double max = column.max.load(std::memory_order_relaxed);
+        bool possible = false;
+        for (double v : literals) {
+            switch (cond.op) {
+                case CompareOp::EQ:
+                case CompareOp::IN: possible = possible || (min <= v && v <= max); break;
+                case CompareOp::LT: possible = min < v; break;
+                case CompareOp::LE: possible = min <= v; break;
+                case CompareOp::GT: possible = max > v; break;
+                case CompareOp::GE: possible = max >= v; break;
+                default: possible = true;
+            }
+        }
+        if (!possible) return false;
+    }
+    return true;
+}
+
+auto Predicate::evaluate(const Row& row) const -> bool {
+    for (const auto& cond : conditions_) {
+        if (!cond.evaluate(row)) return false;
+    }
+    return true;
+}
+
+auto Predicate::empty() const -> bool {
+    return conditions_.empty();
+}
+
+auto Predicate::getConditions() const -> const std::vector<Condition>& {
+    return conditions_;
+}
+
+auto Predicate::toString() const -> std::string {
+    std::vector<std::string> parts;
+    for (const auto& cond : conditions_) {
+        parts.push_back(cond.toString());
+    }
+    return fmt::format("{}", fmt::join(parts, " AND "));
+}
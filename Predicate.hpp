@@ -0,0 +1,71 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Compare.hpp"
+#include "Mvcc.hpp"
+#include "Row.hpp"
+#include "Value.hpp"
+
+CompareOp stringToCompareOp(const std::string& s);
+std::string compareOpToString(CompareOp op);
+
+class Table;
+
+// one comparison, the right hand side is either a literal or another column
+struct Condition {
+    std::string column;
+    CompareOp op;
+    bool rhs_is_column = false;
+    std::string rhs_column;
+    Value rhs_value;
+    std::optional<size_t> param = std::nullopt; // rhs is $n of a prepared statement, rhs_value is set by Predicate::bind
+    // the list of an IN, set instead of rhs_value. in_params[i] is the $n in_values[i] is bound from
+    std::vector<Value> in_values{};
+    std::vector<std::optional<size_t>> in_params{};
+    CompareKernel kernel = nullptr; // picked by chooseKernel, nullptr compares generically
+    // position of column in the table, set by Predicate::boundTo. IS NULL and IS NOT NULL are
+    // answered from the validity bits there (see RowChunk)
+    std::optional<size_t> column_index = std::nullopt;
+
+    bool evaluate(const Row& row) const;
+    // the kernel for column's type, once the rhs is known. rhs_column_type is the type of
+    // rhs_column for a comparison of two columns
+    void chooseKernel(DataType column_type, DataType rhs_column_type = DataType::NULL_VALUE);
+    std::string toString() const;
+};
+
+// conjunction of conditions, compiled once per statement instead of re-parsing the clause for every row
+class Predicate {
+private:
+    std::vector<Condition> conditions_;
+
+public:
+    Predicate() = default;
+    explicit Predicate(std::vector<Condition> conditions) : conditions_(std::move(conditions)) {}
+
+    static Predicate parse(const std::string& where_clause);
+
+    size_t parameterCount() const; // highest $n used
+    void bind(const std::vector<Value>& params); // fills in the rhs of every $n condition
+    // this predicate bound to the columns of table, once per statement: typed compare kernels
+    // (see Compare.hpp) and the literals compared with a dictionary encoded column swapped for
+    // their coded form, so equality and IN compare codes (see Dictionary.hpp).
+    // conditions name unqualified columns
+    Predicate boundTo(const Table& table) const;
+    // the slots of chunk in rows that can match: the live ones, narrowed down by the IS NULL and
+    // IS NOT NULL conditions of a bound predicate with word-wide operations on the validity
+    // bits. exact if those were all of the conditions, the rows left match without evaluating
+    // them. false if rows has no usable bits for chunk (see RowView::bits)
+    bool candidates(const RowView& rows, size_t chunk, RowView::SlotMask& mask, bool& exact) const;
+    // false if no row of chunk can match a bound predicate, from the chunk's zone maps: a
+    // comparison with a literal outside the bounds of the column there rules the chunk out
+    bool mayMatch(const RowChunk& chunk) const;
+
+    bool evaluate(const Row& row) const;
+    bool empty() const;
+    const std::vector<Condition>& getConditions() const;
+    std::string toString() const;
+};
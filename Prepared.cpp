@@ -0,0 +1,188 @@
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "Prepared.hpp"
+#include "Commands.hpp"
+#include "Executor.hpp"
+#include "Join.hpp"
+#include "Lexer.hpp"
+
+PreparedStatement::PreparedStatement(std::string name, std::string query, std::unique_ptr<Command> command,
+                                     std::vector<ParameterSlot> slots, const Database& database)
+    : name_(std::move(name)),
+      query_(std::move(query)),
+      command_(std::move(command)),
+      slots_(std::move(slots)) {
+    if (!command_) {
+        throw std::runtime_error("nothing to prepare");
+    }
+
+    std::vector<std::string> table_names;
+    switch (command_->getType()) {
+        case CommandType::SELECT:
+            table_names = static_cast<const SelectCommand&>(*command_).getTableNames();
+            break;
+        case CommandType::INSERT:
+            table_names = {static_cast<const InsertCommand&>(*command_).getTableName()};
+            break;
+        case CommandType::UPDATE:
+            table_names = {static_cast<const UpdateCommand&>(*command_).getTableName()};
+            break;
+        case CommandType::DELETE:
+            table_names = {static_cast<const DeleteCommand&>(*command_).getTableName()};
+            break;
+        default:
+            throw std::runtime_error("only SELECT, INSERT, UPDATE and DELETE can be prepared");
+    }
+
+    std::vector<JoinInput> inputs;
+    for (const auto& table_name : table_names) {
+        auto table = database.getTable(table_name);
+        if (!table) {
+            throw std::runtime_error(fmt::format("table '{}' doesnt exist", table_name));
+        }
+        inputs.push_back({table_name, table});
+    }
+    ColumnResolver resolver(std::move(inputs));
+
+    // every parameter takes the type of the column it is compared with or stored into
+    plan_ = Executor::plan(*command_, database);
+    for (const auto& cond : plan_.predicate.getConditions()) {
+        auto lhs = resolver.resolve(cond.column);
+        if (cond.rhs_is_column) resolver.resolve(cond.rhs_column);
+        if (cond.param) expectType(*cond.param, lhs.column->getType());
+        for (const auto& param : cond.in_params) {
+            if (param) expectType(*param, lhs.column->getType());
+        }
+    }
+
+    for (const auto& slot : slots_) {
+        std::string column_name = slot.column_name;
+        if (slot.kind == ParameterSlot::Kind::INSERT_VALUE) {
+            const auto& columns = plan_.columns;
+            if (slot.column >= columns.size()) {
+                throw std::runtime_error(fmt::format("parameter ${} has no matching column in INSERT", slot.index + 1));
+            }
+            column_name = columns[slot.column];
+        }
+        expectType(slot.index, resolver.resolve(column_name).column->getType());
+    }
+}
+
+auto PreparedStatement::expectType(size_t index, DataType type) -> void {
+    if (types_.size() <= index) {
+        types_.resize(index + 1, DataType::NULL_VALUE);
+    }
+    if (types_[index] == DataType::NULL_VALUE) {
+        types_[index] = type;
+    } else if (types_[index] != type) {
+        throw std::runtime_error(fmt::format("parameter ${} is used as both {} and {}",
+            index + 1, dataTypeToString(types_[index]), dataTypeToString(type)));
+    }
+}
+
+auto PreparedStatement::getName() const -> const std::string& {
+    return name_;
+}
+
+auto PreparedStatement::getCommand() const -> const Command& {
+    return *command_;
+}
+
+auto PreparedStatement::getPlan() const -> const Plan& {
+    return plan_;
+}
+
+auto PreparedStatement::parameterCount() const -> size_t {
+    return types_.size();
+}
+
+auto PreparedStatement::getParameterTypes() const -> const std::vector<DataType>& {
+    return types_;
+}
+
+auto PreparedStatement::bind(const std::vector<Value>& params, bool widen_integers) -> void {
+    if (params.size() != types_.size()) {
+        throw std::runtime_error(fmt::format("prepared statement '{}' expects {} parameter(s), got {}",
+            name_, types_.size(), params.size()));
+    }
+
+    std::vector<Value> bound = params;
+    for (size_t i = 0; i < bound.size(); i++) {
+        auto expected = types_[i];
+        auto actual = bound[i].getType();
+        if (bound[i].isNull() || expected == DataType::NULL_VALUE || actual == expected) continue;
+        if (widen_integers && expected == DataType::FLOAT && actual == DataType::INTEGER) {
+            bound[i] = Value(static_cast<double>(bound[i].get<int>()));
+            continue;
+        }
+        throw std::runtime_error(fmt::format("parameter ${} expects {}, got {}",
+            i + 1, dataTypeToString(expected), dataTypeToString(actual)));
+    }
+
+    for (const auto& slot : slots_) {
+        if (slot.kind == ParameterSlot::Kind::INSERT_VALUE) {
+            static_cast<InsertCommand&>(*command_).setValue(slot.row, slot.column, bound[slot.index]);
+        } else {
+            static_cast<UpdateCommand&>(*command_).setColumnValue(slot.column_name, bound[slot.index]);
+        }
+    }
+    plan_.predicate.bind(bound);
+    params_ = std::move(bound);
+}
+
+// value as a literal that tokenToValue turns back into the same value
+static auto appendLiteral(std::string& out, const Value& value) -> void {
+    switch (value.getType()) {
+        case DataType::NULL_VALUE:
+            out += "NULL";
+            return;
+        case DataType::INTEGER:
+            value.appendTo(out);
+            return;
+        case DataType::FLOAT: {
+            // shortest form that reads back as the same double, with a '.' so it isn't read as an INTEGER
+            double v = value.get<double>();
+            if (!std::isfinite(v)) break;
+            char buffer[32];
+            auto end = std::to_chars(buffer, buffer + sizeof(buffer), v).ptr;
+            out.append(buffer, end);
+            if (std::string_view(buffer, end - buffer).find_first_of(".e") == std::string_view::npos) out += ".0";
+            return;
+        }
+        case DataType::BOOLEAN:
+            out += value.get<bool>() ? "TRUE" : "FALSE";
+            return;
+        case DataType::STRING: {
+            // strings have no escapes, either quote works as long as the string doesn't hold it
+            auto text = value.get<std::string_view>();
+            char quote = text.find('\'') == std::string_view::npos ? '\'' : '"';
+            if (text.find(quote) != std::string_view::npos) break;
+            out += quote;
+            out += text;
+            out += quote;
+            return;
+        }
+        default:
+            break;
+    }
+    throw std::runtime_error(fmt::format("can't write {} value '{}' as a literal",
+        dataTypeToString(value.getType()), value.toString()));
+}
+
+auto PreparedStatement::boundQuery() const -> std::string {
+    std::string out;
+    Lexer lexer(query_);
+    Token token = lexer.next();
+    size_t copied = token.pos; // from the first token, PREPARE keeps the space after AS
+    for (; !token.empty(); token = lexer.next()) {
+        if (token.kind != TokenKind::PARAMETER) continue;
+        out.append(query_, copied, token.pos - copied);
+        appendLiteral(out, params_.at(parameterIndex(token)));
+        copied = token.pos + token.text.size();
+    }
+    out.append(query_, copied);
+    return out;
+}
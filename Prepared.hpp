@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Command.hpp"
+#include "Database.hpp"
+#include "Plan.hpp"
+#include "Value.hpp"
+
+// where a $n placeholder outside of WHERE sits in the parsed command, WHERE placeholders are tracked by Predicate
+struct ParameterSlot {
+    enum class Kind {
+        INSERT_VALUE, // values[row][column] of an INSERT
+        SET_VALUE,    // column_name = $n in an UPDATE
+    };
+
+    Kind kind;
+    size_t index; // 0 for $1
+    size_t row = 0;
+    size_t column = 0;
+    std::string column_name;
+};
+
+// a statement parsed, bound to its tables and columns and planned once. executing it only writes
+// the parameters into the command and the predicate, the SQL text is never looked at again
+class PreparedStatement {
+private:
+    std::string name_;
+    std::string query_; // with the $n placeholders
+    std::unique_ptr<Command> command_;
+    Plan plan_;
+    std::vector<ParameterSlot> slots_;
+    std::vector<DataType> types_; // expected type of every parameter, NULL_VALUE if anything goes
+    std::vector<Value> params_; // as last bound, integers widened
+
+    void expectType(size_t index, DataType type);
+
+public:
+    // throws if a table or column the statement uses doesn't exist
+    PreparedStatement(std::string name, std::string query, std::unique_ptr<Command> command,
+                      std::vector<ParameterSlot> slots, const Database& database);
+
+    const std::string& getName() const;
+    const Command& getCommand() const;
+    const Plan& getPlan() const;
+    size_t parameterCount() const;
+    const std::vector<DataType>& getParameterTypes() const;
+
+    // type checks the parameters and binds them. integers are widened for FLOAT columns unless
+    // widen_integers is off, then every parameter has to have its column's type exactly
+    void bind(const std::vector<Value>& params, bool widen_integers = true);
+    // the query with the parameters last bound written in as literals, what the command log gets
+    // for an EXECUTE. a statement name only means something in its session, the text replays
+    // the same anywhere. throws for a value no literal gives back exactly
+    std::string boundQuery() const;
+};
@@ -0,0 +1,53 @@
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "Protocol.hpp"
+
+static auto appendLength(std::string& out, size_t length) -> void {
+    if (length > MAX_FRAME_SIZE) {
+        throw std::runtime_error(fmt::format("frame of {} bytes is over the {} byte limit", length, MAX_FRAME_SIZE));
+    }
+    out += static_cast<char>((length >> 24) & 0xff);
+    out += static_cast<char>((length >> 16) & 0xff);
+    out += static_cast<char>((length >> 8) & 0xff);
+    out += static_cast<char>(length & 0xff);
+}
+
+auto appendRequest(std::string& out, std::string_view statement, ResultFormat format) -> void {
+    appendLength(out, statement.size() + 1);
+    out += static_cast<char>(format);
+    out += statement;
+}
+
+auto appendResponse(std::string& out, ResponseStatus status, std::string_view body) -> void {
+    appendLength(out, body.size() + 1);
+    out += static_cast<char>(status);
+    out += body;
+}
+
+auto completeFrameSize(std::string_view data) -> size_t {
+    if (data.size() < FRAME_HEADER_SIZE) return 0;
+    size_t length = 0;
+    for (size_t i = 0; i < FRAME_HEADER_SIZE; i++) {
+        length = (length << 8) | static_cast<unsigned char>(data[i]);
+    }
+    if (length > MAX_FRAME_SIZE) {
+        throw std::runtime_error(fmt::format("frame of {} bytes is over the {} byte limit", length, MAX_FRAME_SIZE));
+    }
+    return data.size() >= FRAME_HEADER_SIZE + length ? FRAME_HEADER_SIZE + length : 0;
+}
+
+auto framePayload(std::string_view frame) -> std::string_view {
+    return frame.substr(FRAME_HEADER_SIZE);
+}
+
+auto parseResponse(std::string_view payload) -> Response {
+    if (payload.empty()) {
+        throw std::runtime_error("empty response");
+    }
+    auto status = static_cast<uint8_t>(payload[0]);
+    if (status > static_cast<uint8_t>(ResponseStatus::ERROR)) {
+        throw std::runtime_error(fmt::format("unknown response status {}", status));
+    }
+    return Response{static_cast<ResponseStatus>(status), std::string(payload.substr(1))};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// the server's wire format. every message is a frame: a 4 byte big-endian payload length, then the payload.
+//   request payload:  one ResultFormat byte, then the statement text
+//   response payload: one status byte, then what the statement printed (rows, messages, errors)
+//                     as text or encoded as in Columnar.hpp
+// clients can pipeline: send any number of requests without waiting, responses come back in order
+
+enum class ResultFormat : uint8_t {
+    TEXT = 0,     // tab separated, like the REPL prints it
+    COLUMNAR = 1, // binary column batches, see Columnar.hpp
+};
+
+enum class ResponseStatus : uint8_t {
+    OK = 0,
+    ERROR = 1, // didn't parse or failed to execute, the text says why
+};
+
+struct Response {
+    ResponseStatus status = ResponseStatus::OK;
+    std::string body;
+};
+
+inline constexpr size_t FRAME_HEADER_SIZE = 4;
+inline constexpr size_t MAX_FRAME_SIZE = 64 << 20; // a bigger length means a broken or hostile peer
+
+void appendRequest(std::string& out, std::string_view statement, ResultFormat format = ResultFormat::TEXT);
+void appendResponse(std::string& out, ResponseStatus status, std::string_view body);
+
+// length of the frame at the start of data, header included. 0 while it is incomplete,
+// throws if the announced length is over MAX_FRAME_SIZE
+size_t completeFrameSize(std::string_view data);
+// payload of a complete frame
+std::string_view framePayload(std::string_view frame);
+Response parseResponse(std::string_view payload);
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <iostream>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "ResultSink.hpp"
+
+static auto appendHeader(std::string& out, const std::vector<std::string>& columns) -> void {
+    for (const auto& col : columns) {
+        out += col;
+        out += '\t';
+    }
+    out += '\n';
+}
+
+static auto appendRow(std::string& out, const std::vector<std::string>& columns, const Row& row) -> void {
+    for (const auto& col : columns) {
+        if (const Value* value = row.find(col)) {
+            value->appendTo(out); // NULL for null
+        } else {
+            out += "NULL";
+        }
+        out += '\t';
+    }
+    out += '\n';
+}
+
+auto StdoutSink::flush() -> void {
+    if (buffer_.empty()) return;
+    std::fwrite(buffer_.data(), 1, buffer_.size(), stdout);
+    buffer_.clear();
+}
+
+auto StdoutSink::header(const std::vector<std::string>& columns) -> void {
+    appendHeader(buffer_, columns);
+}
+
+auto StdoutSink::row(const std::vector<std::string>& columns, const Row& row) -> void {
+    appendRow(buffer_, columns, row);
+    if (buffer_.size() >= FLUSH_BYTES) flush();
+}
+
+auto StdoutSink::message(std::string_view text) -> void {
+    buffer_ += text;
+    buffer_ += '\n';
+    flush();
+}
+
+auto StdoutSink::error(std::string_view text) -> void {
+    flush();
+    fmt::print(std::cerr, "{}\n", text);
+}
+
+auto StringSink::header(const std::vector<std::string>& columns) -> void {
+    appendHeader(text_, columns);
+}
+
+auto StringSink::row(const std::vector<std::string>& columns, const Row& row) -> void {
+    appendRow(text_, columns, row);
+}
+
+auto StringSink::message(std::string_view text) -> void {
+    text_ += text;
+    text_ += '\n';
+}
+
+auto StringSink::error(std::string_view text) -> void {
+    text_ += text;
+    text_ += '\n';
+}
+
+auto stdoutSink() -> ResultSink& {
+    static StdoutSink sink;
+    return sink;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Row.hpp"
+
+// where an executor sends result rows and messages. the REPL prints them, server
+// connections collect them into the response for the statement
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    virtual void header(const std::vector<std::string>& columns) = 0;
+    virtual void row(const std::vector<std::string>& columns, const Row& row) = 0;
+    virtual void message(std::string_view text) = 0; // a line of text, the newline is added
+    virtual void error(std::string_view text) = 0;
+    virtual void finish() {} // the statement is done, anything buffered goes out
+};
+
+// tab separated rows and messages on stdout, errors on stderr. rows are collected and written
+// FLUSH_BYTES at a time, messages, errors and finish() write out what is collected first
+class StdoutSink : public ResultSink {
+public:
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+private:
+    std::string buffer_;
+
+    void flush();
+
+public:
+    ~StdoutSink() override { flush(); }
+
+    void header(const std::vector<std::string>& columns) override;
+    void row(const std::vector<std::string>& columns, const Row& row) override;
+    void message(std::string_view text) override;
+    void error(std::string_view text) override;
+    void finish() override { flush(); }
+};
+
+// the same text as StdoutSink, errors included, appended to a string
+class StringSink : public ResultSink {
+private:
+    std::string text_;
+
+public:
+    void header(const std::vector<std::string>& columns) override;
+    void row(const std::vector<std::string>& columns, const Row& row) override;
+    void message(std::string_view text) override;
+    void error(std::string_view text) override;
+
+    const std::string& text() const { return text_; }
+    void clear() { text_.clear(); } // keeps the capacity for the next statement
+};
+
+ResultSink& stdoutSink(); // shared by everything that doesn't say otherwise
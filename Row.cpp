@@ -5,12 +5,45 @@
 #include "Row.hpp"
 #include "Column.hpp"
 
+Row::Row(const Row& other, std::pmr::memory_resource* resource)
+    : values(other.schema_ && !other.schema_->current ? ValueMap(resource) : ValueMap(other.values, resource)) {
+    if (!other.schema_ || other.schema_->current) return;
+    values.reserve(other.schema_->columns.size());
+    for (const auto& [name, source] : other.schema_->columns) {
+        if (auto value = other.find(name)) values.emplace(name, *value);
+    }
+}
+
+auto Row::operator=(const Row& other) -> Row& {
+    if (this != &other) {
+        Row copy(other, values.get_allocator().resource());
+        values = std::move(copy.values);
+        schema_ = nullptr;
+    }
+    return *this;
+}
+
 auto Row::getValue(const std::string& column_name) const -> const Value& {
-    return values.at(column_name);
+    if (auto value = find(column_name)) return *value;
+    throw std::out_of_range(column_name);
 }
 
 auto Row::getValue(const Column& col) const -> const Value& {
-    return values.at(col.getName());
+    return getValue(col.getName());
+}
+
+auto Row::find(const std::string& column_name) const -> const Value* {
+    const std::string* key = &column_name;
+    if (schema_ && !schema_->current) {
+        auto source = schema_->columns.find(column_name);
+        if (source == schema_->columns.end()) return nullptr;
+        if (source->second.key.empty()) {
+            return source->second.fallback.isNull() ? nullptr : &source->second.fallback;
+        }
+        key = &source->second.key;
+    }
+    auto it = values.find(*key);
+    return it != values.end() ? &it->second : nullptr;
 }
 
 void Row::setValue(const std::string& column_name, const Value& val) {
@@ -18,11 +51,11 @@ void Row::setValue(const std::string& column_name, const Value& val) {
 }
 
 auto Row::hasColumn(const std::string& column_name) const -> bool {
-    return values.find(column_name) != values.end();
+    return find(column_name) != nullptr;
 }
 
 auto Row::hasColumn(const Column& col) const -> bool {
-    return values.find(col.getName()) != values.end();
+    return find(col.getName()) != nullptr;
 }
 
 auto Row::getValues() const -> const ValueMap& {
@@ -11,17 +11,44 @@
 #include "Value.hpp"
 #include "CommonTypes.hpp"
 
+// the columns of a table as the rows written under one version of its schema keep them. ALTER
+// TABLE leaves the rows alone: RENAME COLUMN and ADD COLUMN ... DEFAULT only change how the
+// versions before look their columns up (see Table::renameColumn)
+struct SchemaVersion {
+    struct Source {
+        std::string key; // what the rows keep the column's value under, empty if they have none
+        Value fallback;  // read when they have none: the DEFAULT of a column added since
+    };
+    bool current = true; // the rows name their values like the table does
+    // by the table's column names, only when !current. a column that isn't here is NULL
+    std::unordered_map<std::string, Source> columns;
+};
+
 class Row {
 private:
     ValueMap values;
+    const SchemaVersion* schema_ = nullptr; // of a row its table stores, nullptr for any other
 
 public:
+    Row() = default;
+    // a copy names its values like the table does now and has no schema version, it allocates
+    // from the default heap wherever other lives
+    Row(const Row& other) : Row(other, std::pmr::get_default_resource()) {}
+    Row(Row&&) = default;
+    Row& operator=(const Row& other);
+    Row& operator=(Row&&) = default;
+    // a copy of other allocated from resource
+    Row(const Row& other, std::pmr::memory_resource* resource);
+
     const Value& getValue(const std::string& column_name) const;
     const Value& getValue(const Column& col) const;
+    const Value* find(const std::string& column_name) const; // nullptr if the row has no such column
     void setValue(const std::string& column_name, const Value& val);
     bool hasColumn(const std::string& column_name) const;
     bool hasColumn(const Column& col) const;
-    const ValueMap& getValues() const;
+    const ValueMap& getValues() const; // as stored, by the names of the row's schema version
+    const SchemaVersion* schema() const { return schema_; }
+    void setSchema(const SchemaVersion* schema) { schema_ = schema; } // by the table storing the row
     int size() const;
     bool empty() const;
     bool removeColumn(const std::string& column_name);
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <thread>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "Script.hpp"
+#include "BoundedQueue.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+
+static auto trim(std::string& s) -> void {
+    auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    size_t end = s.size();
+    while (end > 0 && is_space(s[end - 1])) end--;
+    size_t start = 0;
+    while (start < end && is_space(s[start])) start++;
+    s.erase(end);
+    s.erase(0, start);
+}
+
+auto StatementReader::next(std::string& statement) -> bool {
+    statement.clear();
+
+    if (mode_ == Mode::LINE) {
+        while (std::getline(input_, statement)) {
+            trim(statement);
+            if (!statement.empty()) return true;
+        }
+        return false;
+    }
+
+    char quote = 0;
+    while (true) {
+        if (pos_ >= line_.size()) {
+            if (!std::getline(input_, line_)) {
+                // the last statement doesn't need a ;
+                line_.clear();
+                pos_ = 0;
+                trim(statement);
+                return !statement.empty();
+            }
+            pos_ = 0;
+            if (!statement.empty()) statement += ' ';
+            continue;
+        }
+
+        char c = line_[pos_++];
+        if (quote) {
+            if (c == quote) quote = 0;
+            statement += c;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            statement += c;
+        } else if (c == '-' && pos_ < line_.size() && line_[pos_] == '-') {
+            pos_ = line_.size(); // comment runs to the end of the line
+        } else if (c == ';') {
+            trim(statement);
+            if (!statement.empty()) return true;
+        } else {
+            statement += c;
+        }
+    }
+}
+
+namespace {
+    struct ParsedStatement {
+        std::string text;
+        std::unique_ptr<Command> command = nullptr; // nullptr if it didn't parse
+        std::string error{};
+    };
+}
+
+auto ScriptRunner::run(std::istream& input, StatementReader::Mode mode) -> size_t {
+    BoundedQueue<ParsedStatement> queue(QUEUE_CAPACITY);
+
+    // the parser never touches the database, so it can work through the script while the
+    // statements before are still executing
+    std::thread parser_thread([&queue, &input, mode] {
+        Parser parser;
+        StatementReader reader(input, mode);
+        std::string text;
+        while (reader.next(text)) {
+            if (iequals(text, "exit")) break;
+
+            ParsedStatement statement{text};
+            try {
+                statement.command = parser.parse(statement.text);
+            } catch (const std::exception& e) {
+                statement.error = e.what();
+            }
+            if (!queue.push(std::move(statement))) break;
+        }
+        queue.close();
+    });
+
+    size_t failed = 0;
+    try {
+        ParsedStatement statement;
+        while (queue.pop(statement)) {
+            if (!statement.command) {
+                if (!statement.error.empty()) {
+                    fmt::print(std::cerr, "error parsing query: {}\n", statement.error);
+                }
+                fmt::println("failed to parse query: {}", statement.text);
+                failed++;
+                continue;
+            }
+
+            if (!session_.execute(statement.command, &statement.text)) {
+                failed++;
+            }
+        }
+    } catch (...) {
+        queue.close(); // unblocks the parser if it is waiting for room
+        parser_thread.join();
+        throw;
+    }
+
+    parser_thread.join();
+    return failed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+#include "Session.hpp"
+
+// pulls statements out of a stream one at a time, the input is never read into memory as a whole
+class StatementReader {
+public:
+    enum class Mode {
+        SEMICOLON, // scripts: statements end at ; outside of quotes and can span lines, -- starts a comment
+        LINE,      // the command log: one statement per line
+    };
+
+private:
+    std::istream& input_;
+    Mode mode_;
+    std::string line_;
+    size_t pos_ = 0; // next unread character of line_
+
+public:
+    StatementReader(std::istream& input, Mode mode) : input_(input), mode_(mode) {}
+
+    // false at the end of the input. statements come out trimmed and on one line, line breaks
+    // become spaces (also inside string literals, the command log is line based)
+    bool next(std::string& statement);
+};
+
+// runs a whole script through a session. statements are parsed on a thread of their own, up to
+// QUEUE_CAPACITY ahead of the one executing, and results come out in statement order.
+// statements that changed something go to the session's logger
+class ScriptRunner {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 256;
+
+private:
+    Session& session_;
+
+public:
+    explicit ScriptRunner(Session& session) : session_(session) {}
+
+    // stops at the end of the input or at a statement that is just "exit".
+    // returns how many statements failed to parse or execute
+    size_t run(std::istream& input, StatementReader::Mode mode);
+};
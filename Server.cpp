@@ -0,0 +1,322 @@
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Server.hpp"
+#include "Protocol.hpp"
+
+static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+static constexpr int LISTEN_BACKLOG = 128;
+
+static auto systemError(const std::string& what) -> std::runtime_error {
+    return std::runtime_error(fmt::format("{}: {}", what, std::strerror(errno)));
+}
+
+Server::Server(Database& database, ServerOptions options, Logger log)
+    : database_(database), options_(std::move(options)), log_(std::move(log)) {}
+
+Server::~Server() {
+    for (auto& worker : workers_) {
+        for (auto& [fd, connection] : worker.connections) {
+            ::close(fd);
+        }
+        if (worker.epoll_fd >= 0) ::close(worker.epoll_fd);
+    }
+    if (tcp_fd_ >= 0) ::close(tcp_fd_);
+    if (unix_fd_ >= 0) {
+        ::close(unix_fd_);
+        ::unlink(options_.socket_path.c_str());
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+}
+
+auto Server::start() -> void {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) throw systemError("eventfd");
+
+    if (options_.port != 0) listenTcp();
+    if (!options_.socket_path.empty()) listenUnix();
+    if (tcp_fd_ < 0 && unix_fd_ < 0) {
+        throw std::runtime_error("server needs a TCP port or a unix socket path");
+    }
+
+    workers_.resize(std::max<size_t>(1, options_.threads));
+    for (auto& worker : workers_) {
+        worker.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (worker.epoll_fd < 0) throw systemError("epoll_create1");
+        watch(worker.epoll_fd, wake_fd_, EPOLLIN, true);
+        // EPOLLEXCLUSIVE wakes one worker per new connection instead of all of them
+        if (tcp_fd_ >= 0) watch(worker.epoll_fd, tcp_fd_, EPOLLIN | EPOLLEXCLUSIVE, true);
+        if (unix_fd_ >= 0) watch(worker.epoll_fd, unix_fd_, EPOLLIN | EPOLLEXCLUSIVE, true);
+    }
+}
+
+auto Server::listenTcp() -> void {
+    tcp_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (tcp_fd_ < 0) throw systemError("socket");
+    int one = 1;
+    setsockopt(tcp_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    if (inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error(fmt::format("invalid IPv4 address '{}'", options_.host));
+    }
+    if (bind(tcp_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw systemError(fmt::format("bind {}:{}", options_.host, options_.port));
+    }
+    if (listen(tcp_fd_, LISTEN_BACKLOG) < 0) throw systemError("listen");
+}
+
+auto Server::listenUnix() -> void {
+    sockaddr_un addr{};
+    if (options_.socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(fmt::format("socket path '{}' is too long", options_.socket_path));
+    }
+    unix_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unix_fd_ < 0) throw systemError("socket");
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, options_.socket_path.c_str(), options_.socket_path.size() + 1);
+    ::unlink(options_.socket_path.c_str()); // left over from a server that didn't shut down cleanly
+    if (bind(unix_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw systemError(fmt::format("bind {}", options_.socket_path));
+    }
+    if (listen(unix_fd_, LISTEN_BACKLOG) < 0) throw systemError("listen");
+}
+
+auto Server::watch(int epoll_fd, int fd, uint32_t events, bool add) -> void {
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) < 0) {
+        throw systemError("epoll_ctl");
+    }
+}
+
+auto Server::run() -> void {
+    running_ = true;
+    std::vector<std::thread> threads;
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto loop = [&](Worker& worker) {
+        try {
+            runWorker(worker);
+        } catch (...) {
+            std::lock_guard lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+            stop(); // one broken loop takes the server down instead of leaving it half served
+        }
+    };
+
+    for (size_t i = 1; i < workers_.size(); i++) {
+        threads.emplace_back(loop, std::ref(workers_[i]));
+    }
+    loop(workers_[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+auto Server::runWorker(Worker& worker) -> void {
+    std::array<epoll_event, 64> events;
+
+    while (running_) {
+        int ready = epoll_wait(worker.epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("epoll_wait");
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == wake_fd_) {
+                break; // running_ is off, the loop condition ends it
+            }
+            if (fd == tcp_fd_ || fd == unix_fd_) {
+                acceptAll(worker, fd);
+                continue;
+            }
+
+            auto it = worker.connections.find(fd);
+            if (it == worker.connections.end()) continue; // closed earlier in this batch
+            auto& connection = *it->second;
+
+            if ((flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readInput(connection)) {
+                closeConnection(worker, fd);
+                continue;
+            }
+            service(worker, connection);
+        }
+    }
+
+    // sessions roll back their open transactions on the thread that holds their latches
+    for (auto& [fd, connection] : worker.connections) {
+        ::close(fd);
+    }
+    worker.connections.clear();
+}
+
+auto Server::stop() -> void {
+    running_ = false;
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one)); // async signal safe
+}
+
+auto Server::acceptAll(Worker& worker, int listen_fd) -> void {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or the client gave up before we got to it
+        }
+        if (listen_fd == tcp_fd_) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->session = std::make_unique<Session>(database_, connection->sink);
+        // the session logs while its latches are held. every connection writes to the one log that is
+        // replayed into a single session, which works because nothing logged refers to the
+        // connection's prepared statements (an EXECUTE is logged as the statement it ran)
+        if (log_) connection->session->setLogger(log_);
+        connection->events = EPOLLIN;
+        watch(worker.epoll_fd, fd, connection->events, true);
+        worker.connections.emplace(fd, std::move(connection));
+        connection_count_++;
+    }
+}
+
+auto Server::readInput(Connection& connection) -> bool {
+    char buffer[READ_CHUNK_SIZE];
+    size_t read = 0;
+    while (read < MAX_READ_PER_EVENT) {
+        ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            connection.input.append(buffer, static_cast<size_t>(n));
+            read += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            connection.closing = true;
+            return true;
+        }
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+auto Server::service(Worker& worker, Connection& connection) -> void {
+    try {
+        processRequests(connection);
+        bool ok = flush(connection);
+        // requests held back by a full output buffer go next if the socket took all of it
+        while (ok && connection.output.empty() && completeFrameSize(connection.input) != 0) {
+            processRequests(connection);
+            ok = flush(connection);
+        }
+        if (!ok) {
+            closeConnection(worker, connection.fd);
+            return;
+        }
+    } catch (const std::exception&) {
+        closeConnection(worker, connection.fd); // oversized frame or a broken socket, the stream can't be trusted anymore
+        return;
+    }
+
+    size_t pending = connection.output.size() - connection.output_sent;
+    uint32_t events = 0;
+    if (!connection.closing && pending < MAX_PENDING_OUTPUT) events |= EPOLLIN;
+    if (pending > 0) events |= EPOLLOUT;
+    if (events == 0) {
+        closeConnection(worker, connection.fd); // the peer is gone and has everything it asked for
+        return;
+    }
+    if (events != connection.events) {
+        watch(worker.epoll_fd, connection.fd, events, false);
+        connection.events = events;
+    }
+}
+
+auto Server::processRequests(Connection& connection) -> void {
+    size_t consumed = 0;
+    while (connection.output.size() - connection.output_sent < MAX_PENDING_OUTPUT) {
+        std::string_view rest(connection.input.data() + consumed, connection.input.size() - consumed);
+        size_t frame_size = completeFrameSize(rest);
+        if (frame_size == 0) break;
+        executeRequest(connection, framePayload(rest.substr(0, frame_size)));
+        consumed += frame_size;
+    }
+    connection.input.erase(0, consumed);
+}
+
+auto Server::executeRequest(Connection& connection, std::string_view payload) -> void {
+    auto& sink = connection.sink;
+    sink.text.clear();
+    sink.columnar.clear();
+    if (payload.empty() || static_cast<uint8_t>(payload[0]) > static_cast<uint8_t>(ResultFormat::COLUMNAR)) {
+        sink.format = ResultFormat::TEXT;
+        sink.error("malformed request, expected a result format byte");
+        appendResponse(connection.output, ResponseStatus::ERROR, sink.text.text());
+        return;
+    }
+    sink.format = static_cast<ResultFormat>(payload[0]);
+    std::string query(payload.substr(1));
+
+    auto result = connection.session->run(query);
+    if (!result.parsed) {
+        sink.error(fmt::format("failed to parse query: {}", query));
+    }
+    sink.finish();
+
+    auto status = result.parsed && result.success ? ResponseStatus::OK : ResponseStatus::ERROR;
+    const auto& body = sink.format == ResultFormat::COLUMNAR ? sink.columnar.data() : sink.text.text();
+    appendResponse(connection.output, status, body);
+}
+
+auto Server::flush(Connection& connection) -> bool {
+    while (connection.output_sent < connection.output.size()) {
+        ssize_t n = ::send(connection.fd, connection.output.data() + connection.output_sent,
+                           connection.output.size() - connection.output_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.output_sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    connection.output.clear();
+    connection.output_sent = 0;
+    return true;
+}
+
+auto Server::closeConnection(Worker& worker, int fd) -> void {
+    epoll_ctl(worker.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    worker.connections.erase(fd);
+    connection_count_--;
+}
+
+auto Server::connectionCount() const -> size_t {
+    return connection_count_;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Columnar.hpp"
+#include "Database.hpp"
+#include "Protocol.hpp"
+#include "ResultSink.hpp"
+#include "Session.hpp"
+
+struct ServerOptions {
+    static constexpr uint16_t DEFAULT_PORT = 5455;
+    static constexpr const char* DEFAULT_SOCKET_PATH = "/tmp/db_cpp.sock";
+
+    std::string host = "127.0.0.1";
+    uint16_t port = DEFAULT_PORT;                    // 0 turns TCP off
+    std::string socket_path = DEFAULT_SOCKET_PATH;   // empty turns the unix socket off
+    size_t threads = std::max(1u, std::thread::hardware_concurrency()); // event loops
+};
+
+// serves one Database to many clients over TCP and a unix socket, see Protocol.hpp for the wire format.
+// every thread runs an epoll loop of its own and a connection stays with the thread that accepted it,
+// so statements of different connections run in parallel as far as their latches let them (readers
+// of a table together, a writer alone). every connection has a Session of its own with its own
+// parser, prepared statements and plan cache.
+// all requests that arrived in one read are answered before anything is written, so a pipelining
+// client gets its responses in a few large writes instead of one per statement
+class Server {
+public:
+    using Logger = Session::Logger;
+
+    static constexpr size_t MAX_PENDING_OUTPUT = 4 << 20; // no more requests are read while this much is unsent
+    static constexpr size_t MAX_READ_PER_EVENT = 1 << 20; // keeps one busy client from starving the others
+
+private:
+    // hands the session's output to the encoder the current request asked for
+    class ResponseSink : public ResultSink {
+    public:
+        StringSink text;
+        ColumnarSink columnar;
+        ResultFormat format = ResultFormat::TEXT;
+
+        ResultSink& current() { return format == ResultFormat::COLUMNAR ? static_cast<ResultSink&>(columnar) : text; }
+
+        void header(const std::vector<std::string>& columns) override { current().header(columns); }
+        void row(const std::vector<std::string>& columns, const Row& row) override { current().row(columns, row); }
+        void message(std::string_view text) override { current().message(text); }
+        void error(std::string_view text) override { current().error(text); }
+        void finish() override { current().finish(); }
+    };
+
+    struct Connection {
+        int fd;
+        ResponseSink sink;
+        std::unique_ptr<Session> session;
+        std::string input;
+        std::string output;
+        size_t output_sent = 0;
+        uint32_t events = 0;  // what epoll watches for right now
+        bool closing = false; // the peer is done sending
+    };
+
+    // one event loop and the connections it accepted, only its own thread touches them
+    struct Worker {
+        int epoll_fd = -1;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    };
+
+    Database& database_;
+    ServerOptions options_;
+    Logger log_; // gets every statement that changed something, may be empty, called from every worker
+    int tcp_fd_ = -1;
+    int unix_fd_ = -1;
+    int wake_fd_ = -1; // eventfd, written by stop() and never read so it wakes every worker
+    std::atomic<bool> running_ = false;
+    std::atomic<size_t> connection_count_ = 0;
+    std::vector<Worker> workers_;
+
+    void listenTcp();
+    void listenUnix();
+    static void watch(int epoll_fd, int fd, uint32_t events, bool add);
+    void runWorker(Worker& worker);
+    void acceptAll(Worker& worker, int listen_fd);
+    bool readInput(Connection& connection); // false if the connection broke
+    void service(Worker& worker, Connection& connection); // answers, writes and closes the connection when it is done
+    void processRequests(Connection& connection);
+    void executeRequest(Connection& connection, std::string_view payload);
+    bool flush(Connection& connection);      // false if the connection broke
+    void closeConnection(Worker& worker, int fd);
+
+public:
+    Server(Database& database, ServerOptions options, Logger log = nullptr);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // binds and listens, throws if a socket can't be set up
+    void start();
+    // handles connections on options.threads threads, this one included, until stop()
+    void run();
+    // safe from other threads and from signal handlers
+    void stop();
+
+    size_t connectionCount() const;
+};
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <optional>
+#include <fmt/format.h>
+
+#include "Session.hpp"
+#include "Commands.hpp"
+
+Session::~Session() {
+    rollback();
+}
+
+auto Session::setLogger(Logger log) -> void {
+    log_ = std::move(log);
+}
+
+auto Session::run(const std::string& query) -> StatementResult {
+    {
+        // held from the lookup on, a cached plan can't go stale before it runs. an open
+        // transaction holds the catalog latch already
+        std::optional<StatementLatches> latches;
+        if (!transaction_latches_) latches.emplace(database_);
+        if (auto statement = cachedPlan(query)) {
+            const auto& command = statement->getCommand();
+            bool success = executeStatement(command, &statement->getPlan(), &query, latches ? &*latches : nullptr);
+            return {true, success, isReadOnly(command)};
+        }
+    }
+
+    auto command = parse(query);
+    if (!command) {
+        return {};
+    }
+    bool success = execute(command, &query);
+    return {true, success, isReadOnly(*command)};
+}
+
+// the cached plan of query with its literals bound, nullptr sends the query through the parser.
+// that also covers every error case, so the parser reports them the same way as without the cache
+auto Session::cachedPlan(const std::string& query) -> std::shared_ptr<PreparedStatement> {
+    try {
+        if (!PlanCache::normalize(query, cache_key_, literals_)) return nullptr;
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+
+    std::shared_ptr<PreparedStatement> statement;
+    if (!plan_cache_.lookup(cache_key_, database_.getSchemaVersion(), statement)) {
+        try {
+            statement = makePrepared("", cache_key_); // run() holds the catalog latch already
+            // a literal the plan has no slot for (select list, ORDER BY...) changes the statement itself
+            const auto& types = statement->getParameterTypes();
+            if (types.size() != literals_.size() ||
+                std::find(types.begin(), types.end(), DataType::NULL_VALUE) != types.end()) {
+                statement = nullptr;
+            }
+        } catch (const std::exception&) {
+            statement = nullptr;
+        }
+        plan_cache_.insert(cache_key_, statement);
+    }
+    if (!statement) return nullptr;
+
+    try {
+        // no int to float widening, the uncached path doesn't do it either
+        statement->bind(literals_, false);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+    return statement;
+}
+
+auto Session::parse(const std::string& query) -> std::unique_ptr<Command> {
+    try {
+        return parser_.parse(query);
+    } catch (const std::exception& e) {
+        sink_.error(fmt::format("error parsing query: {}", e.what()));
+        return nullptr;
+    }
+}
+
+auto Session::execute(const std::unique_ptr<Command>& command) -> bool {
+    return execute(command, nullptr);
+}
+
+auto Session::execute(const std::unique_ptr<Command>& command, const std::string* query) -> bool {
+    if (!command) {
+        return executor_.execute(command);
+    }
+
+    try {
+        if (command->getType() == CommandType::PREPARE) {
+            const auto& c = static_cast<const PrepareCommand&>(*command);
+            auto statement = prepare(c.getName(), c.getStatement());
+            sink_.message(fmt::format("prepared statement '{}' with {} parameter(s)", c.getName(), statement->parameterCount()));
+            return true;
+        }
+        if (command->getType() == CommandType::EXECUTE) {
+            const auto& c = static_cast<const ExecuteCommand&>(*command);
+            auto statement = getPrepared(c.getName());
+            if (!statement) {
+                throw std::runtime_error(fmt::format("prepared statement '{}' doesnt exist", c.getName()));
+            }
+            return execute(*statement, c.getParameters(), query);
+        }
+    } catch (const std::exception& e) {
+        sink_.error(fmt::format("error executing command: {}", e.what()));
+        return false;
+    }
+
+    return executeStatement(*command, nullptr, query);
+}
+
+auto Session::executeStatement(const Command& command, const Plan* plan, const std::string* query,
+                               StatementLatches* latched) -> bool {
+    if (transaction_latches_) {
+        return executeInTransaction(command, plan, query);
+    }
+    if (command.getType() == CommandType::BEGIN) {
+        transaction_latches_ = std::make_unique<TransactionLatches>(database_);
+        if (!executor_.execute(command, plan)) {
+            transaction_latches_.reset();
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<StatementLatches> latches;
+    if (latched) {
+        latched->lockTables(command);
+    } else {
+        latches.emplace(database_, command);
+    }
+    bool success = executor_.execute(command, plan);
+    if (success) log(command, query);
+    return success;
+}
+
+auto Session::executeInTransaction(const Command& command, const Plan* plan, const std::string* query) -> bool {
+    try {
+        transaction_latches_->lockTables(command);
+    } catch (const std::exception& e) {
+        // another transaction may be waiting for ours, only letting go of everything helps
+        endTransaction(false);
+        sink_.error(fmt::format("error executing command: {}, transaction rolled back", e.what()));
+        return false;
+    }
+
+    bool success = executor_.execute(command, plan);
+    if (success && query && !isReadOnly(command)) transaction_log_.push_back(*query);
+    if (!executor_.inTransaction()) {
+        endTransaction(command.getType() == CommandType::COMMIT && success);
+    }
+    return success;
+}
+
+// logs the transaction if it committed and lets go of its latches, after the executor ended it
+auto Session::endTransaction(bool commit) -> void {
+    executor_.rollbackTransaction(); // nothing left to do after a COMMIT
+    if (commit && log_ && !transaction_log_.empty()) {
+        transaction_log_.insert(transaction_log_.begin(), "BEGIN");
+        transaction_log_.push_back("COMMIT");
+        log_(transaction_log_); // replaying a batch cut short by a crash rolls it back
+    }
+    transaction_log_.clear();
+    transaction_latches_.reset();
+}
+
+auto Session::log(const Command& command, const std::string* query) -> void {
+    if (query && log_ && !isReadOnly(command)) log_({*query});
+}
+
+auto Session::isReadOnly(const Command& command) const -> bool {
+    switch (command.getType()) {
+        case CommandType::SELECT:
+        case CommandType::SHOW:
+        case CommandType::HELP:
+        case CommandType::PREPARE: // only session state, its EXECUTEs are logged as what they ran
+        case CommandType::BEGIN:
+        case CommandType::COMMIT:
+        case CommandType::ROLLBACK:
+            return true;
+        case CommandType::EXECUTE: {
+            auto statement = getPrepared(static_cast<const ExecuteCommand&>(command).getName());
+            return statement && statement->getCommand().getType() == CommandType::SELECT;
+        }
+        default:
+            return false;
+    }
+}
+
+auto Session::inTransaction() const -> bool {
+    return transaction_latches_ != nullptr;
+}
+
+auto Session::rollback() -> void {
+    if (transaction_latches_) endTransaction(false);
+}
+
+auto Session::prepare(const std::string& query) -> std::shared_ptr<PreparedStatement> {
+    return prepare("", query);
+}
+
+auto Session::prepare(const std::string& name, const std::string& query) -> std::shared_ptr<PreparedStatement> {
+    // binding reads the tables' columns. an open transaction holds the latch already
+    std::shared_lock<std::shared_mutex> latch;
+    if (!transaction_latches_) latch = std::shared_lock(database_.catalogLatch());
+    return makePrepared(name, query);
+}
+
+auto Session::makePrepared(const std::string& name, const std::string& query) -> std::shared_ptr<PreparedStatement> {
+    auto command = parser_.parse(query, true);
+    if (!command) {
+        throw std::runtime_error(fmt::format("failed to parse statement: {}", query));
+    }
+    auto statement = std::make_shared<PreparedStatement>(name, query, std::move(command), parser_.getParameters(), database_);
+    if (!name.empty()) {
+        prepared_[name] = statement;
+    }
+    return statement;
+}
+
+auto Session::execute(PreparedStatement& statement, const std::vector<Value>& params) -> bool {
+    return execute(statement, params, nullptr);
+}
+
+auto Session::execute(PreparedStatement& statement, const std::vector<Value>& params, const std::string* query) -> bool {
+    std::string bound;
+    try {
+        statement.bind(params);
+        // the log gets the statement with its parameters in it, the EXECUTE would replay whatever
+        // statement has that name in the replaying session then
+        if (query && log_ && !isReadOnly(statement.getCommand())) {
+            bound = statement.boundQuery();
+            query = &bound;
+        }
+    } catch (const std::exception& e) {
+        sink_.error(fmt::format("error executing command: {}", e.what()));
+        return false;
+    }
+    return executeStatement(statement.getCommand(), &statement.getPlan(), query);
+}
+
+auto Session::getPrepared(const std::string& name) const -> std::shared_ptr<PreparedStatement> {
+    auto it = prepared_.find(name);
+    return it != prepared_.end() ? it->second : nullptr;
+}
+
+auto Session::getDatabase() const -> Database& {
+    return database_;
+}
+
+auto Session::getPlanCache() const -> const PlanCache& {
+    return plan_cache_;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Command.hpp"
+#include "Database.hpp"
+#include "Executor.hpp"
+#include "Latch.hpp"
+#include "Parser.hpp"
+#include "PlanCache.hpp"
+#include "Prepared.hpp"
+#include "ResultSink.hpp"
+
+struct StatementResult {
+    bool parsed = false;    // false if the text isn't a statement, the error is printed already
+    bool success = false;
+    bool read_only = false; // nothing to write to the command log
+};
+
+// one client's parser and executor, created once and reused for every statement it sends.
+// also owns the client's prepared statements, plan cache and open transaction. sessions of
+// different clients can run statements on the same Database from different threads, every
+// statement takes its latches (see Latch.hpp) for as long as it runs, a transaction until it ends
+class Session {
+public:
+    // gets statements that changed something, every call is one batch for the log to write at once
+    using Logger = std::function<void(const std::vector<std::string>&)>;
+
+private:
+    Database& database_;
+    ResultSink& sink_;
+    Logger log_;
+    std::unique_ptr<TransactionLatches> transaction_latches_; // set while a transaction is open
+    std::vector<std::string> transaction_log_; // its statements, logged as one batch on COMMIT
+    Parser parser_;
+    Executor executor_;
+    std::unordered_map<std::string, std::shared_ptr<PreparedStatement>> prepared_;
+    PlanCache plan_cache_;
+    std::string cache_key_; // reused between statements
+    std::vector<Value> literals_;
+
+    std::shared_ptr<PreparedStatement> cachedPlan(const std::string& query);
+    std::shared_ptr<PreparedStatement> makePrepared(const std::string& name, const std::string& query);
+    bool execute(PreparedStatement& statement, const std::vector<Value>& params, const std::string* query);
+    // runs command under the open transaction's latches, or latched holds the catalog latch
+    // already, or it takes its own. then logs query
+    bool executeStatement(const Command& command, const Plan* plan, const std::string* query,
+                          StatementLatches* latched = nullptr);
+    bool executeInTransaction(const Command& command, const Plan* plan, const std::string* query);
+    void endTransaction(bool commit);
+    void log(const Command& command, const std::string* query);
+
+public:
+    // results, messages and errors of every statement go to sink
+    explicit Session(Database& database, ResultSink& sink = stdoutSink())
+        : database_(database), sink_(sink), executor_(database, sink) {}
+    ~Session(); // rolls back a transaction left open
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // statements that changed something go to log before their latches are let go, so with several
+    // sessions the log has them in the order they were applied. a transaction's statements wait
+    // for its COMMIT and go as one batch between BEGIN and COMMIT lines
+    void setLogger(Logger log);
+
+    // plan cache first, parse and execute if the statement isn't cacheable
+    StatementResult run(const std::string& query);
+
+    std::unique_ptr<Command> parse(const std::string& query); // nullptr (and the error printed) if it doesn't parse
+    bool execute(const std::unique_ptr<Command>& command); // PREPARE and EXECUTE are handled here
+    // query is the text to log if the statement changes something, nullptr logs nothing
+    bool execute(const std::unique_ptr<Command>& command, const std::string* query);
+    // SELECT, SHOW, HELP, PREPARE, EXECUTE of a SELECT and BEGIN, COMMIT and ROLLBACK, which the
+    // log only has around the statements of a transaction
+    bool isReadOnly(const Command& command) const;
+    bool inTransaction() const;
+    void rollback(); // drops an open transaction, nothing happens without one
+
+    // C++ API, throws if the statement can't be parsed or bound. a named statement replaces
+    // any earlier one with that name and can also be run with EXECUTE name(...)
+    std::shared_ptr<PreparedStatement> prepare(const std::string& query);
+    std::shared_ptr<PreparedStatement> prepare(const std::string& name, const std::string& query);
+    bool execute(PreparedStatement& statement, const std::vector<Value>& params);
+    std::shared_ptr<PreparedStatement> getPrepared(const std::string& name) const; // nullptr if unknown
+
+    Database& getDatabase() const;
+    const PlanCache& getPlanCache() const;
+};
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <fmt/format.h>
+
+#include "Sort.hpp"
+
+auto OrderByItem::toString() const -> std::string {
+    return descending ? fmt::format("{} DESC", column) : column;
+}
+
+auto RowComparator::operator()(const Row& a, const Row& b) const -> bool {
+    static const Value null_value;
+    for (size_t i = 0; i < items_.size(); i++) {
+        const auto& item = items_[i];
+        const Value* va = a.find(item.column);
+        const Value* vb = b.find(item.column);
+
+        int cmp = kernels_[i](va ? *va : null_value, vb ? *vb : null_value);
+        if (cmp != 0) {
+            return item.descending ? cmp > 0 : cmp < 0;
+        }
+    }
+    return false;
+}
+
+auto RowComparator::bind(const std::vector<DataType>& types) -> void {
+    for (size_t i = 0; i < items_.size() && i < types.size(); i++) {
+        kernels_[i] = orderKernel(types[i]);
+    }
+}
+
+auto RowComparator::getItems() const -> const std::vector<OrderByItem>& {
+    return items_;
+}
+
+auto TopK::push(const Row& row) -> void {
+    if (k_ == 0) return;
+    if (heap_.size() < k_) {
+        heap_.push_back(row);
+        std::push_heap(heap_.begin(), heap_.end(), less_);
+        return;
+    }
+    // the heap is full, the new row only gets in if it goes before the current last one
+    if (less_(row, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), less_);
+        heap_.back() = row;
+        std::push_heap(heap_.begin(), heap_.end(), less_);
+    }
+}
+
+auto TopK::finish() -> RowList {
+    std::sort_heap(heap_.begin(), heap_.end(), less_);
+    return std::move(heap_);
+}
+
+auto sortRows(RowList& rows, const RowComparator& less) -> void {
+    std::stable_sort(rows.begin(), rows.end(), less);
+}
+
+auto applyLimit(RowList& rows, size_t offset, std::optional<size_t> limit) -> void {
+    if (offset >= rows.size()) {
+        rows.clear();
+        return;
+    }
+    rows.erase(rows.begin(), rows.begin() + offset);
+    if (limit && *limit < rows.size()) {
+        rows.erase(rows.begin() + *limit, rows.end());
+    }
+}
+
+static auto appendBigEndian(std::string& out, uint64_t v, int bytes) -> void {
+    for (int i = bytes - 1; i >= 0; i--) {
+        out.push_back(static_cast<char>((v >> (i * 8)) & 0xff));
+    }
+}
+
+auto encodeSortKey(const Row& row, const std::vector<OrderByItem>& items, std::vector<DataType>& types,
+                   std::string& out) -> void {
+    types.resize(items.size(), DataType::NULL_VALUE);
+    for (size_t i = 0; i < items.size(); i++) {
+        const auto& item = items[i];
+        size_t start = out.size();
+        const Value* v = row.hasColumn(item.column) ? &row.getValue(item.column) : nullptr;
+
+        if (!v || v->isNull()) {
+            out.push_back('\0'); // NULL goes before every value
+        } else {
+            auto type = v->getType();
+            // an INTEGER stored in a FLOAT column would sort by its tag, not by its value.
+            // RowComparator can't order them either
+            if (types[i] == DataType::NULL_VALUE) {
+                types[i] = type;
+            } else if (types[i] != type) {
+                throw std::runtime_error("cannot compare values of different types");
+            }
+            out.push_back(static_cast<char>(1 + static_cast<int>(type)));
+            switch (type) {
+                case DataType::INTEGER:
+                    // flipping the sign bit makes two's complement sort as unsigned
+                    appendBigEndian(out, static_cast<uint32_t>(v->get<int>()) ^ 0x80000000u, 4);
+                    break;
+                case DataType::FLOAT: {
+                    double d = v->get<double>();
+                    if (d == 0.0) d = 0.0; // -0.0 equals 0.0
+                    uint64_t bits;
+                    std::memcpy(&bits, &d, sizeof(bits));
+                    // negative floats sort backwards, positive ones just need the sign bit set
+                    bits = (bits & 0x8000000000000000ull) ? ~bits : bits ^ 0x8000000000000000ull;
+                    appendBigEndian(out, bits, 8);
+                    break;
+                }
+                case DataType::BOOLEAN:
+                    out.push_back(v->get<bool>() ? '\1' : '\0');
+                    break;
+                case DataType::STRING:
+                    // 0x00 is escaped as 0x00 0xff and the string ends with 0x00 0x00,
+                    // so a prefix sorts before the longer string
+                    for (char ch : v->get<std::string_view>()) {
+                        out.push_back(ch);
+                        if (ch == '\0') out.push_back('\xff');
+                    }
+                    out.push_back('\0');
+                    out.push_back('\0');
+                    break;
+                case DataType::DATE: {
+                    auto days = std::chrono::sys_days(v->get<Date>()).time_since_epoch().count();
+                    appendBigEndian(out, static_cast<uint32_t>(days) ^ 0x80000000u, 4);
+                    break;
+                }
+                case DataType::DATETIME: {
+                    auto ms = v->get<DateTime>().time_since_epoch().count();
+                    appendBigEndian(out, static_cast<uint64_t>(ms) ^ 0x8000000000000000ull, 8);
+                    break;
+                }
+                default:
+                    throw std::runtime_error("unsupported type in sort key");
+            }
+        }
+
+        if (item.descending) {
+            for (size_t i = start; i < out.size(); i++) {
+                out[i] = static_cast<char>(~out[i]);
+            }
+        }
+    }
+}
+
+// unsigned byte order, shorter key first on a common prefix
+static auto keyLess(const std::string& a, const std::string& b) -> bool {
+    int cmp = std::memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    return cmp != 0 ? cmp < 0 : a.size() < b.size();
+}
+
+// rough heap footprint of a buffered entry, only used to decide when to spill
+static auto entrySize(const ExternalSort::Entry& entry) -> size_t {
+    size_t size = sizeof(entry) + entry.key.capacity();
+    for (const auto& [col, value] : entry.row.getValues()) {
+        size += sizeof(Value) + col.capacity() + 48; // plus the hash node and bucket
+        if (value.getType() == DataType::STRING) size += value.get<std::string_view>().size();
+    }
+    return size;
+}
+
+// run files are a sequence of entries: key, column count, then name, type tag and payload per column
+
+static auto writeBytes(std::FILE* f, const void* data, size_t size) -> void {
+    if (size && std::fwrite(data, 1, size, f) != size) {
+        throw std::runtime_error("failed to write sort run");
+    }
+}
+
+static auto readBytes(std::FILE* f, void* data, size_t size) -> void {
+    if (size && std::fread(data, 1, size, f) != size) {
+        throw std::runtime_error("failed to read sort run");
+    }
+}
+
+template<typename T>
+static auto writePod(std::FILE* f, T v) -> void {
+    writeBytes(f, &v, sizeof(v));
+}
+
+template<typename T>
+static auto readPod(std::FILE* f) -> T {
+    T v;
+    readBytes(f, &v, sizeof(v));
+    return v;
+}
+
+static auto writeString(std::FILE* f, std::string_view s) -> void {
+    writePod<uint32_t>(f, static_cast<uint32_t>(s.size()));
+    writeBytes(f, s.data(), s.size());
+}
+
+static auto readString(std::FILE* f) -> std::string {
+    std::string s(readPod<uint32_t>(f), '\0');
+    readBytes(f, s.data(), s.size());
+    return s;
+}
+
+static auto writeEntry(std::FILE* f, const ExternalSort::Entry& entry) -> void {
+    writeString(f, entry.key);
+    const auto& values = entry.row.getValues();
+    writePod<uint32_t>(f, static_cast<uint32_t>(values.size()));
+    for (const auto& [col, value] : values) {
+        writeString(f, col);
+        auto type = value.getType();
+        writePod<uint8_t>(f, static_cast<uint8_t>(type));
+        switch (type) {
+            case DataType::INTEGER: writePod(f, value.get<int>()); break;
+            case DataType::FLOAT: writePod(f, value.get<double>()); break;
+            case DataType::BOOLEAN: writePod<uint8_t>(f, value.get<bool>()); break;
+            case DataType::STRING: writeString(f, value.get<std::string_view>()); break;
+            case DataType::DATE:
+                writePod<int32_t>(f, std::chrono::sys_days(value.get<Date>()).time_since_epoch().count());
+                break;
+            case DataType::DATETIME:
+                writePod<int64_t>(f, value.get<DateTime>().time_since_epoch().count());
+                break;
+            case DataType::NULL_VALUE: break;
+        }
+    }
+}
+
+// false at the end of the run
+static auto readEntry(std::FILE* f, ExternalSort::Entry& entry) -> bool {
+    uint32_t key_size;
+    if (std::fread(&key_size, 1, sizeof(key_size), f) != sizeof(key_size)) {
+        return false;
+    }
+    entry.key.resize(key_size);
+    readBytes(f, entry.key.data(), key_size);
+
+    entry.row = Row();
+    auto count = readPod<uint32_t>(f);
+    for (uint32_t i = 0; i < count; i++) {
+        auto col = readString(f);
+        Value value;
+        switch (static_cast<DataType>(readPod<uint8_t>(f))) {
+            case DataType::INTEGER: value = Value(readPod<int>(f)); break;
+            case DataType::FLOAT: value = Value(readPod<double>(f)); break;
+            case DataType::BOOLEAN: value = Value(readPod<uint8_t>(f) != 0); break;
+            case DataType::STRING: value = Value(readString(f)); break;
+            case DataType::DATE:
+                value = Value(Date(std::chrono::sys_days(std::chrono::days(readPod<int32_t>(f)))));
+                break;
+            case DataType::DATETIME:
+                value = Value(DateTime(std::chrono::milliseconds(readPod<int64_t>(f))));
+                break;
+            case DataType::NULL_VALUE: break;
+        }
+        entry.row.setValue(col, value);
+    }
+    return true;
+}
+
+auto ExternalSort::RunReader::advance() -> void {
+    valid = readEntry(file.get(), current);
+}
+
+auto ExternalSort::push(Row row) -> void {
+    if (finished_) {
+        throw std::runtime_error("push after finish in external sort");
+    }
+    Entry entry{std::string(), std::move(row)};
+    encodeSortKey(entry.row, items_, types_, entry.key);
+    // the sequence number makes every key unique and keeps equal rows in push order across runs
+    appendBigEndian(entry.key, sequence_++, 8);
+
+    memory_.add(entrySize(entry));
+    buffer_.push_back(std::move(entry));
+    // past the process wide limit the sort gives back what it holds rather than failing
+    if (memory_.bytes() >= memory_limit_ || (memory_.bytes() >= MIN_LIMITED_RUN && overMemoryLimit())) {
+        spill();
+    }
+}
+
+auto ExternalSort::spill() -> void {
+    std::sort(buffer_.begin(), buffer_.end(), [](const Entry& a, const Entry& b) {
+        return keyLess(a.key, b.key);
+    });
+
+    File file(std::tmpfile(), &std::fclose); // removed by the OS once closed
+    if (!file) {
+        throw std::runtime_error("failed to create a temp file for sorting");
+    }
+    for (const auto& entry : buffer_) {
+        writeEntry(file.get(), entry);
+    }
+    std::rewind(file.get());
+    runs_.push_back(std::move(file));
+
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    memory_.release();
+}
+
+auto ExternalSort::openReaders(std::vector<File> runs) -> void {
+    readers_.clear();
+    heap_.clear();
+    readers_.reserve(runs.size());
+    for (auto& run : runs) {
+        readers_.push_back(RunReader{std::move(run), Entry{}, false});
+        readers_.back().advance();
+        if (readers_.back().valid) heap_.push_back(readers_.size() - 1);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) {
+        return keyLess(readers_[b].current.key, readers_[a].current.key);
+    });
+}
+
+auto ExternalSort::popEntry(Entry& out) -> bool {
+    if (heap_.empty()) return false;
+    auto greater = [this](size_t a, size_t b) {
+        return keyLess(readers_[b].current.key, readers_[a].current.key);
+    };
+
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    auto& reader = readers_[heap_.back()];
+    std::swap(out, reader.current);
+    reader.advance();
+    if (reader.valid) {
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+        heap_.pop_back();
+    }
+    return true;
+}
+
+auto ExternalSort::mergeRuns(std::vector<File> runs) -> File {
+    File file(std::tmpfile(), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("failed to create a temp file for sorting");
+    }
+    openReaders(std::move(runs));
+    Entry entry;
+    while (popEntry(entry)) {
+        writeEntry(file.get(), entry);
+    }
+    readers_.clear(); // closes the merged inputs
+    std::rewind(file.get());
+    return file;
+}
+
+auto ExternalSort::finish() -> void {
+    if (finished_) return;
+    finished_ = true;
+
+    if (runs_.empty()) {
+        // everything fit, no files involved
+        std::sort(buffer_.begin(), buffer_.end(), [](const Entry& a, const Entry& b) {
+            return keyLess(a.key, b.key);
+        });
+        return;
+    }
+
+    if (!buffer_.empty()) spill();
+
+    // intermediate passes until one merge can take every run
+    while (runs_.size() > MAX_FAN_IN) {
+        std::vector<File> group;
+        for (size_t i = 0; i < MAX_FAN_IN; i++) {
+            group.push_back(std::move(runs_[i]));
+        }
+        runs_.erase(runs_.begin(), runs_.begin() + MAX_FAN_IN);
+        runs_.push_back(mergeRuns(std::move(group)));
+    }
+    openReaders(std::move(runs_));
+    runs_.clear();
+}
+
+auto ExternalSort::next() -> const Row* {
+    finish();
+    if (readers_.empty()) {
+        if (buffer_pos_ >= buffer_.size()) return nullptr;
+        return &buffer_[buffer_pos_++].row;
+    }
+    if (!popEntry(current_)) return nullptr;
+    return &current_.row;
+}
+
+auto ExternalSort::runCount() const -> size_t {
+    return runs_.size() + readers_.size();
+}
+
+auto sortMemoryLimit() -> size_t {
+    static const size_t limit = [] {
+        const char* env = std::getenv("DB_SORT_MEMORY");
+        auto value = env ? parseByteSize(env) : std::nullopt;
+        return value && *value != 0 ? *value : ExternalSort::DEFAULT_MEMORY_LIMIT;
+    }();
+    return limit;
+}
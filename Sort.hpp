@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CommonTypes.hpp"
+#include "Compare.hpp"
+#include "Memory.hpp"
+#include "Row.hpp"
+#include "Value.hpp"
+
+struct OrderByItem {
+    std::string column;
+    bool descending = false;
+
+    std::string toString() const;
+};
+
+// strict weak ordering of rows by ORDER BY items, NULL (or a missing column) is the smallest value
+class RowComparator {
+private:
+    std::vector<OrderByItem> items_;
+    std::vector<OrderKernel> kernels_; // per item, compareOrder until bound to column types
+
+public:
+    explicit RowComparator(std::vector<OrderByItem> items)
+        : items_(std::move(items)), kernels_(items_.size(), compareOrder) {}
+
+    // typed kernels (see Compare.hpp) for the types of the ORDER BY columns, in item order
+    void bind(const std::vector<DataType>& types);
+
+    bool operator()(const Row& a, const Row& b) const; // true if a goes before b
+    const std::vector<OrderByItem>& getItems() const;
+};
+
+// keeps the first k rows of the ordering in a bounded max-heap, O(N log K) instead of sorting all N
+class TopK {
+private:
+    RowComparator less_;
+    size_t k_;
+    RowList heap_; // heap_.front() is the row that leaves first
+
+public:
+    TopK(RowComparator less, size_t k) : less_(std::move(less)), k_(k) {}
+
+    void push(const Row& row); // only copies the row if it makes it into the heap
+    RowList finish(); // the kept rows, ordered
+};
+
+void sortRows(RowList& rows, const RowComparator& less);
+// drops the first offset rows and everything after limit
+void applyLimit(RowList& rows, size_t offset, std::optional<size_t> limit);
+
+// ORDER BY items encoded into a byte string whose memcmp order is the RowComparator order,
+// so sorting compares plain bytes instead of going through Value::operator< per column.
+// types holds the type each item's values had in the keys encoded so far (NULL_VALUE before the
+// first), a value of another type throws like RowComparator does
+void encodeSortKey(const Row& row, const std::vector<OrderByItem>& items, std::vector<DataType>& types,
+                   std::string& out);
+
+// sort operator for inputs that may not fit in memory. rows are buffered with their normalized
+// key until memory_limit bytes are used or the process is past its memory limit, then the buffer
+// is sorted and spilled to a temp file as one run. finish() merges the runs k-way (in several
+// passes above MAX_FAN_IN runs) and next() streams the result. the sort is stable, ties keep
+// their push order
+class ExternalSort {
+public:
+    static constexpr size_t DEFAULT_MEMORY_LIMIT = size_t{64} << 20;
+    // runs merged at once, bounds open files and merge buffers
+    static constexpr size_t MAX_FAN_IN = 64;
+    // smallest run spilled for the process memory limit, a process over it would otherwise write
+    // a run per row
+    static constexpr size_t MIN_LIMITED_RUN = size_t{1} << 20;
+
+    struct Entry {
+        std::string key;
+        Row row;
+    };
+
+private:
+    using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+    struct RunReader {
+        File file;
+        Entry current;
+        bool valid = false;
+
+        void advance();
+    };
+
+    std::vector<OrderByItem> items_;
+    std::vector<DataType> types_; // of the values pushed so far, see encodeSortKey
+    size_t memory_limit_;
+    MemoryCharge memory_; // the buffered entries
+    uint64_t sequence_ = 0;
+
+    std::vector<Entry> buffer_;
+    std::vector<File> runs_;
+
+    // merge state once finish() was called
+    bool finished_ = false;
+    size_t buffer_pos_ = 0;
+    std::vector<RunReader> readers_;
+    std::vector<size_t> heap_; // indexes into readers_, min-heap on the current key
+    Entry current_;
+
+    void spill();
+    void openReaders(std::vector<File> runs);
+    bool popEntry(Entry& out); // smallest entry of the open runs
+    File mergeRuns(std::vector<File> runs);
+
+public:
+    explicit ExternalSort(std::vector<OrderByItem> items, size_t memory_limit = DEFAULT_MEMORY_LIMIT)
+        : items_(std::move(items)), memory_limit_(memory_limit) {}
+
+    void push(Row row);
+    void finish();
+    const Row* next(); // nullptr once exhausted, the row stays valid until the next call
+
+    size_t runCount() const; // spilled runs, 0 if everything was sorted in memory
+};
+
+// memory budget of one sort, DB_SORT_MEMORY env var (bytes, K/M/G suffix allowed) or the default
+size_t sortMemoryLimit();
@@ -13,18 +13,36 @@
 #include "Table.hpp"
 #include "Column.hpp"
 
-Table::Table(std::string name) : name_(std::move(name)) {
+Table::Table(std::string name) : name_(std::move(name)), chunks_(std::make_shared<RowChunkList>()) {
+    schema_versions_.push_back(std::make_unique<SchemaVersion>());
     if (name_.empty()) {
         throw std::runtime_error("table name cannot be empty");
     }
 }
-Table::Table(const std::string& name, const std::vector<Column>& columns) : name_(name), columns_(columns) {
+Table::Table(const std::string& name, const std::vector<Column>& columns)
+    : name_(name), columns_(columns), chunks_(std::make_shared<RowChunkList>()) {
+    schema_versions_.push_back(std::make_unique<SchemaVersion>());
     if (name_.empty()) {
         throw std::runtime_error("table name cannot be empty");
     }
     for (int i = 0; i < columns_.size(); i++) {
         column_index_map_[columns_[i].getName()] = i;
+        unsorted_columns_.try_emplace(columns_[i].getName(), false);
+        if (columns_[i].getType() == DataType::STRING) {
+            dictionaries_[columns_[i].getName()] = std::make_unique<StringDictionary>();
+        }
+    }
+}
+
+// the schema versions so far start looking their columns up by name, the rows written from
+// now on get a new one. before ALTER TABLE changes columns_
+auto Table::newSchemaVersion() -> void {
+    auto& version = *schema_versions_.back();
+    version.current = false;
+    for (const auto& column : columns_) {
+        version.columns[column.getName()] = {column.getName(), Value()};
     }
+    schema_versions_.push_back(std::make_unique<SchemaVersion>());
 }
 
 auto Table::addColumn(const Column& column) -> void {
@@ -33,8 +51,40 @@ auto Table::addColumn(const Column& column) -> void {
             fmt::format("column already exists: {}", column.getName())
         );
     }
+    Value fallback;
+    for (const auto& constraint : column.getConstraints()) {
+        if (constraint->getType() == ConstraintType::DEFAULT) {
+            fallback = static_cast<const DefaultConstraint&>(*constraint).getDefaultValue();
+        }
+    }
+    // existing rows read the DEFAULT through their schema version, none of them is rewritten
+    if (!fallback.isNull() && slot_count_ > 0) {
+        newSchemaVersion();
+        for (size_t i = 0; i + 1 < schema_versions_.size(); i++) {
+            schema_versions_[i]->columns[column.getName()] = {std::string(), fallback};
+        }
+    }
+
     columns_.push_back(std::move(column));
     column_index_map_[columns_.back().getName()] = columns_.size() - 1;
+    // existing rows have no value for it
+    unsorted_columns_.try_emplace(columns_.back().getName(), live_rows_ > 0);
+    if (columns_.back().getType() == DataType::STRING) {
+        dictionaries_[columns_.back().getName()] = std::make_unique<StringDictionary>();
+    }
+    for (const auto& chunk : *chunks_) {
+        if (!chunk) continue;
+        auto bits = std::make_unique<ChunkColumn>(columns_.back().getType()); // all NULL
+        if (!fallback.isNull() && chunk->rows > 0) {
+            for (size_t w = 0; w < RowChunk::WORDS; w++) {
+                bits->valid[w].store(chunk->live[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            bits->widen(fallback);
+            bits->payload.store(chunk->rows * fallback.payloadSize(), std::memory_order_relaxed);
+            bits->allocated.store(chunk->rows * ChunkColumn::storedSize(fallback), std::memory_order_relaxed);
+        }
+        chunk->columns.push_back(std::move(bits));
+    }
 }
 
 auto Table::getColumn(const std::string& name) const -> const Column& {
@@ -61,26 +111,310 @@ auto Table::getColumnIndex(const std::string& name) const -> size_t {
     return column_index_map_.at(name);
 }
 
+auto Table::memoryUse() const -> MemoryUse {
+    std::shared_ptr<const RowChunkList> chunks;
+    {
+        std::lock_guard lock(chunks_mutex_);
+        chunks = chunks_;
+    }
+    MemoryUse use;
+    use.column_allocated.resize(columns_.size());
+    use.column_payload.resize(columns_.size());
+    for (const auto& chunk : *chunks) {
+        if (!chunk) continue;
+        use.rows += chunk->arena.allocated() + chunk->heap.allocated();
+        use.index += chunk->memory.bytes();
+        for (size_t i = 0; i < chunk->columns.size() && i < columns_.size(); i++) {
+            const auto& column = *chunk->columns[i];
+            use.index += column.memory.bytes();
+            use.column_allocated[i] += column.allocated.load(std::memory_order_relaxed);
+            use.column_payload[i] += column.payload.load(std::memory_order_relaxed);
+        }
+    }
+    return use;
+}
+
+auto Table::rows(const Snapshot& snapshot) const -> RowView {
+    std::shared_ptr<const RowChunkList> chunks;
+    {
+        std::lock_guard lock(chunks_mutex_);
+        chunks = chunks_;
+    }
+    // only the last chunk grows, the ones before it are full
+    size_t slots = chunks->empty() ? 0 : (chunks->size() - 1) * RowChunk::CAPACITY +
+                                         chunks->back()->size.load(std::memory_order_acquire);
+    return RowView(std::move(chunks), slots, snapshot.timestamp());
+}
+
+auto Table::rows() const -> RowView {
+    return rows(Snapshot());
+}
+
+auto Table::newest(RowId slot) const -> RowVersion* {
+    if (slot >= slot_count_) {
+        throw std::out_of_range(
+            fmt::format("row index out of range, exists: {} accessing: {}", slot_count_, slot)
+        );
+    }
+    const auto& chunk = (*chunks_)[slot / RowChunk::CAPACITY];
+    return chunk ? chunk->slots[slot % RowChunk::CAPACITY].load(std::memory_order_relaxed) : nullptr;
+}
+
+auto Table::newestRow(RowId slot) const -> const Row* {
+    auto version = newest(slot);
+    return version && !version->deleted ? &version->row : nullptr;
+}
+
+auto Table::replace(RowId slot, std::unique_ptr<RowVersion> version) -> void {
+    auto& chunk = *(*chunks_)[slot / RowChunk::CAPACITY];
+    size_t index = slot % RowChunk::CAPACITY;
+    RowVersion* old = chunk.slots[index].load(std::memory_order_relaxed);
+    version->older.store(old, std::memory_order_relaxed);
+    RowVersion* raw = version.release();
+    chunk.beginWrite();
+    chunk.slots[index].store(raw, std::memory_order_release);
+    chunk.setBits(index, raw->deleted ? nullptr : &raw->row,
+                  old && !old->deleted ? &old->row : nullptr, columns_);
+    undo_.push_back({slot, raw, std::unique_ptr<RowVersion>(old)});
+}
+
+auto Table::publish(std::shared_ptr<const RowChunkList> chunks) -> void {
+    std::lock_guard lock(chunks_mutex_);
+    chunks_ = std::move(chunks);
+}
+
+auto Table::markUnsorted(const std::string& column) -> void {
+    auto it = unsorted_columns_.find(column);
+    if (it != unsorted_columns_.end()) it->second.store(true, std::memory_order_relaxed);
+}
+
+auto Table::encode(Row& row) const -> void {
+    for (const auto& [column, dictionary] : dictionaries_) {
+        if (row.hasColumn(column)) row.setValue(column, dictionary->encode(row.getValue(column)));
+    }
+}
+
+auto Table::dictionary(const std::string& column) const -> const StringDictionary* {
+    auto it = dictionaries_.find(column);
+    return it != dictionaries_.end() ? it->second.get() : nullptr;
+}
+
 auto Table::addRow(const Row& row) -> void {
     if (!validateRow(row)) {
         throw std::runtime_error("row validation failed");
     }
-    rows_.push_back(std::move(row));
+
+    const Row* prev = nullptr;
+    for (size_t slot = slot_count_; slot > 0 && !prev; slot--) {
+        prev = newestRow(slot - 1);
+    }
+    for (const auto& col : columns_) {
+        const auto& name = col.getName();
+        if (!isSortedBy(name)) continue;
+        // a sorted column has no NULLs and no type changes, so values compare with each other
+        if (!row.hasColumn(name) || row.getValue(name).isNull()) {
+            markUnsorted(name);
+            continue;
+        }
+        if (!prev) continue;
+        const auto& prev_value = prev->getValue(name);
+        const auto& cur = row.getValue(name);
+        if (prev_value.getType() != cur.getType() || cur < prev_value) {
+            markUnsorted(name);
+        }
+    }
+
+    // a full last chunk gets a successor, the rows already stored never move
+    if (slot_count_ % RowChunk::CAPACITY == 0) {
+        auto chunks = std::make_shared<RowChunkList>(*chunks_);
+        chunks->push_back(std::make_shared<RowChunk>(columns_));
+        publish(std::move(chunks));
+    }
+    auto& chunk = *chunks_->back();
+    size_t index = slot_count_ % RowChunk::CAPACITY;
+    RowVersion* raw = chunk.newVersion(row);
+    raw->row.setSchema(schema_versions_.back().get());
+    encode(raw->row);
+    chunk.beginWrite();
+    chunk.slots[index].store(raw, std::memory_order_release);
+    chunk.setBits(index, &raw->row, nullptr, columns_);
+    chunk.size.store(index + 1, std::memory_order_release);
+    undo_.push_back({slot_count_, raw, nullptr});
+    slot_count_++;
+    live_rows_++;
 }
 
-auto Table::getRows() const -> const RowList& { return rows_; }
+auto Table::updateRow(RowId slot, const std::unordered_map<std::string, Value>& values) -> void {
+    RowVersion* current = newest(slot);
+    if (!current || current->deleted) {
+        throw std::runtime_error(fmt::format("row {} of '{}' is deleted", slot, name_));
+    }
+    // always a new version, even over one of our own uncommitted ones, so rollback can go back to it
+    std::unique_ptr<RowVersion> version((*chunks_)[slot / RowChunk::CAPACITY]->heapVersion(current->row));
+    for (const auto& [column, value] : values) {
+        auto it = dictionaries_.find(column);
+        version->row.setValue(column, it != dictionaries_.end() ? it->second->encode(value) : value);
+    }
+    version->row.setSchema(schema_versions_.back().get());
+    replace(slot, std::move(version));
 
-auto Table::getRow(size_t index) -> Row& {
-    if (index >= rows_.size()) {
-        throw std::out_of_range(
-            std::format("row index out of range, exists: {} accessing: {}", rows_.size(), index)
-        );
+    const Row* prev = nullptr;
+    const Row* next = nullptr;
+    bool looked = false;
+    for (const auto& [column, value] : values) {
+        if (!isSortedBy(column)) continue;
+        // the column stays sorted as long as the new value still fits between its live neighbours
+        if (!looked) {
+            for (size_t i = slot; i > 0 && !prev; i--) prev = newestRow(i - 1);
+            for (size_t i = slot + 1; i < slot_count_ && !next; i++) next = newestRow(i);
+            looked = true;
+        }
+        auto fits = [&](const Row* neighbour, bool before) {
+            if (!neighbour) return true;
+            const auto& other = neighbour->getValue(column);
+            if (other.getType() != value.getType()) return false;
+            return before ? !(value < other) : !(other < value);
+        };
+        if (value.isNull() || !fits(prev, true) || !fits(next, false)) {
+            markUnsorted(column);
+        }
+    }
+}
+
+auto Table::deleteRow(RowId slot) -> void {
+    if (!newestRow(slot)) {
+        throw std::runtime_error(fmt::format("row {} of '{}' is already deleted", slot, name_));
+    }
+    std::unique_ptr<RowVersion> version((*chunks_)[slot / RowChunk::CAPACITY]->newVersion(Row()));
+    version->deleted = true;
+    replace(slot, std::move(version));
+    live_rows_--;
+    deleted_chunks_.insert(slot / RowChunk::CAPACITY);
+}
+
+auto Table::clearRows() -> void {
+    // the sorted flags stay, snapshots from before this still see the old rows
+    for (size_t slot = 0; slot < slot_count_; slot++) {
+        if (newestRow(slot)) deleteRow(slot);
+    }
+}
+
+auto Table::rowCount() const -> size_t { return live_rows_; }
+
+auto Table::isSortedBy(const std::string& column) const -> bool {
+    auto it = unsorted_columns_.find(column);
+    return it != unsorted_columns_.end() && !it->second.load(std::memory_order_relaxed);
+}
+
+auto Table::commit(uint64_t timestamp) -> void {
+    for (auto& entry : undo_) {
+        entry.version->begin.store(timestamp, std::memory_order_release);
+        // nobody reads at timestamp before the clock publishes it, the order doesn't matter
+        (*chunks_)[entry.slot / RowChunk::CAPACITY]->changed.store(timestamp, std::memory_order_release);
+        if (entry.replaced) {
+            retired_.push_back({timestamp, entry.version, (*chunks_)[entry.slot / RowChunk::CAPACITY],
+                                std::move(entry.replaced)});
+        }
+    }
+    undo_.clear();
+}
+
+auto Table::savepoint() const -> size_t {
+    return undo_.size();
+}
+
+auto Table::rollback(size_t savepoint, uint64_t committed) -> void {
+    std::set<size_t> touched; // chunks whose bits changed
+    while (undo_.size() > savepoint) {
+        auto entry = std::move(undo_.back());
+        undo_.pop_back();
+        size_t index = entry.slot % RowChunk::CAPACITY;
+        auto chunk_ptr = (*chunks_)[entry.slot / RowChunk::CAPACITY];
+        auto& chunk = *chunk_ptr;
+        bool was_live = !entry.version->deleted;
+        chunk.beginWrite();
+        touched.insert(entry.slot / RowChunk::CAPACITY);
+
+        if (entry.replaced) {
+            bool is_live = !entry.replaced->deleted;
+            chunk.setBits(index, is_live ? &entry.replaced->row : nullptr,
+                          was_live ? &entry.version->row : nullptr, columns_);
+            chunk.slots[index].store(entry.replaced.release(), std::memory_order_release);
+            live_rows_ += static_cast<size_t>(is_live) - static_cast<size_t>(was_live);
+        } else {
+            // inserts are appends and come off the end again, later writes to the row are undone already
+            chunk.setBits(index, nullptr, &entry.version->row, columns_);
+            chunk.slots[index].store(nullptr, std::memory_order_release);
+            chunk.size.store(index, std::memory_order_release);
+            slot_count_--;
+            live_rows_--;
+            if (index == 0) {
+                auto chunks = std::make_shared<RowChunkList>(*chunks_);
+                chunks->pop_back();
+                publish(std::move(chunks));
+                // a delete undone before may have marked the chunk that is gone now
+                deleted_chunks_.erase(deleted_chunks_.lower_bound(chunks_->size()), deleted_chunks_.end());
+            }
+        }
+        // a snapshot that is open now may have loaded the version just before it went away, every
+        // snapshot after the next commit can't
+        retired_.push_back({committed + 1, nullptr, std::move(chunk_ptr), std::unique_ptr<RowVersion>(entry.version)});
+    }
+
+    // the chunks hold committed versions only again, unless writes before savepoint are still in
+    // them. committed + 1 keeps the bits away from snapshots that are open now, see RowChunk::changed
+    for (const auto& entry : undo_) touched.erase(entry.slot / RowChunk::CAPACITY);
+    for (size_t index : touched) {
+        if (index < chunks_->size() && (*chunks_)[index]) {
+            (*chunks_)[index]->changed.store(committed + 1, std::memory_order_release);
+        }
     }
-    return rows_[index];
 }
 
-auto Table::rowCount() const -> size_t { return rows_.size(); }
+auto Table::collect(uint64_t horizon) -> void {
+    // a snapshot at or after horizon stops at the newer version and never follows the link
+    while (!retired_.empty() && retired_.front().end <= horizon) {
+        if (auto newer = retired_.front().newer) newer->older.store(nullptr, std::memory_order_release);
+        retired_.pop_front();
+    }
+
+    std::shared_ptr<RowChunkList> chunks;
+    for (auto it = deleted_chunks_.begin(); it != deleted_chunks_.end();) {
+        size_t index = *it;
+        if (index >= chunks_->size()) {
+            it = deleted_chunks_.erase(it); // rolled back along with its rows
+            continue;
+        }
+        const auto& chunk = (*chunks_)[index];
+        if (index + 1 == chunks_->size() || !chunk) {
+            ++it; // the last chunk still takes appends
+            continue;
+        }
+        if (chunk->rows > 0) {
+            it = deleted_chunks_.erase(it); // the next delete in it brings it back
+            continue;
+        }
+        if (!droppable(*chunk, horizon)) {
+            ++it;
+            continue;
+        }
+        if (!chunks) chunks = std::make_shared<RowChunkList>(*chunks_);
+        (*chunks)[index] = nullptr; // readers still holding the old list keep the chunk alive
+        it = deleted_chunks_.erase(it);
+    }
+    if (chunks) publish(std::move(chunks));
+}
 
+auto Table::droppable(const RowChunk& chunk, uint64_t horizon) const -> bool {
+    for (const auto& slot : chunk.slots) {
+        const RowVersion* version = slot.load(std::memory_order_relaxed);
+        if (version->begin.load(std::memory_order_relaxed) > horizon ||
+            version->older.load(std::memory_order_relaxed)) {
+            return false; // a snapshot can still see the row before it was deleted
+        }
+    }
+    return true;
+}
 
 auto Table::addConstraint(ConstraintPtr c) -> void {
     constraints_.push_back(std::move(c));
@@ -126,13 +460,18 @@ auto Table::validateRow(const Row& row) const -> bool {
 
 auto Table::clear() -> void {
     columns_.clear();
-    rows_.clear();
     constraints_.clear();
     column_index_map_.clear();
+    unsorted_columns_.clear();
+    dictionaries_.clear();
+    undo_.clear();
+    retired_.clear();
+    deleted_chunks_.clear();
+    publish(std::make_shared<RowChunkList>());
+    slot_count_ = 0;
+    live_rows_ = 0;
 }
 
-auto Table::clearRows() -> void { rows_.clear(); }
-
 auto Table::getPrimaryKeyConstraint() const -> ConstraintPtr {
     for (const auto& constraint : constraints_) {
         if (constraint->getType() == ConstraintType::PRIMARY_KEY) {
@@ -156,8 +495,28 @@ auto Table::dropColumn(const std::string& name) -> void {
     auto it = std::find_if(columns_.begin(), columns_.end(), 
         [&name](const Column& col) { return col.getName() == name; });
     if (it != columns_.end()) {
+        size_t position = std::distance(columns_.begin(), it);
+        for (const auto& chunk : *chunks_) {
+            if (!chunk) continue;
+            chunk->columns.erase(chunk->columns.begin() + position);
+            // the values go now. only the newest versions, no snapshot can see the others any more
+            // (DDL waits for every statement and transaction to end)
+            for (size_t index = 0; index < chunk->size.load(std::memory_order_relaxed); index++) {
+                RowVersion* version = chunk->slots[index].load(std::memory_order_relaxed);
+                if (!version || version->deleted) continue;
+                const SchemaVersion* schema = version->row.schema();
+                if (!schema || schema->current) {
+                    version->row.removeColumn(name);
+                } else if (auto source = schema->columns.find(name); source != schema->columns.end()) {
+                    if (!source->second.key.empty()) version->row.removeColumn(source->second.key);
+                }
+            }
+        }
+        for (auto& version : schema_versions_) version->columns.erase(name);
         columns_.erase(it);
         column_index_map_.erase(name);
+        unsorted_columns_.erase(name);
+        dictionaries_.erase(name);
         // update indices for remaining columns, it may be a little overhead?
         for (size_t i = 0; i < columns_.size(); i++) {
             column_index_map_[columns_[i].getName()] = i;
@@ -169,8 +528,31 @@ auto Table::renameColumn(const std::string& old_name, const std::string& new_nam
     auto it = std::find_if(columns_.begin(), columns_.end(), 
         [&old_name](const Column& col) { return col.getName() == old_name; });
     if (it != columns_.end()) {
+        // the rows keep their values under the old name, their schema versions know it
+        if (slot_count_ > 0) newSchemaVersion();
+        for (auto& version : schema_versions_) {
+            auto source = version->columns.extract(old_name);
+            if (!source.empty()) {
+                source.key() = new_name;
+                version->columns.insert(std::move(source));
+            }
+        }
         it->setName(new_name);
         column_index_map_.erase(old_name);
         column_index_map_[new_name] = std::distance(columns_.begin(), it);
+        auto node = unsorted_columns_.extract(old_name);
+        if (!node.empty()) {
+            node.key() = new_name;
+            unsorted_columns_.insert(std::move(node));
+        }
+        auto dictionary = dictionaries_.extract(old_name);
+        if (!dictionary.empty()) {
+            dictionary.key() = new_name;
+            dictionaries_.insert(std::move(dictionary));
+        }
     }
 }
+
+auto Table::latch() const -> std::shared_timed_mutex& {
+    return latch_;
+}
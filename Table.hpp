@@ -5,7 +5,12 @@
 #ifndef TABLE_H
 #define TABLE_H
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,14 +19,63 @@
 #include "Column.hpp"
 #include "Constraint.hpp"
 #include "CommonTypes.hpp"
+#include "Dictionary.hpp"
+#include "Mvcc.hpp"
 
 class Table {
 private:
     std::string name_;
     ColumnList columns_;
-    RowList rows_;
     ConstraintList constraints_;
     std::unordered_map<std::string, size_t> column_index_map_;
+    // per column: values are known not to be in ascending row order. kept up to date on writes so
+    // the planner can tell which columns a scan comes out sorted by. the set of columns only
+    // changes with DDL, writers flip the flags while readers plan
+    std::unordered_map<std::string, std::atomic<bool>> unsorted_columns_;
+    // one per STRING column, values are encoded on their way into a row. like unsorted_columns_
+    // the set only changes with DDL
+    std::unordered_map<std::string, std::unique_ptr<StringDictionary>> dictionaries_;
+    // versions of the schema the rows were written under, the last one is the current one. never
+    // freed while the table lives, old versions of rows may still point at any of them
+    std::vector<std::unique_ptr<SchemaVersion>> schema_versions_;
+    // held exclusive by the statement or transaction writing the rows and shared by a statement
+    // checking foreign keys against them (see Latch.hpp). readers go through a snapshot instead.
+    // timed, a transaction gives up on a table after a while instead of deadlocking
+    mutable std::shared_timed_mutex latch_;
+
+    // row versions (see Mvcc.hpp). readers copy the chunk list pointer, the writer replaces it
+    // when it adds or drops a chunk. everything else below belongs to the writer
+    std::shared_ptr<const RowChunkList> chunks_;
+    mutable std::mutex chunks_mutex_;
+    size_t slot_count_ = 0;
+    size_t live_rows_ = 0;
+
+    struct UndoEntry {
+        RowId slot;
+        RowVersion* version;                 // owned by its slot
+        std::unique_ptr<RowVersion> replaced; // what the slot held before, nullptr for an insert
+    };
+    // the undo log: versions written by the running statement or transaction in write order,
+    // visible once committed. rolling back puts the replaced versions back in reverse order
+    std::vector<UndoEntry> undo_;
+
+    struct RetiredVersion {
+        uint64_t end;       // commit that replaced it. a rolled back version is freed after it too
+        RowVersion* newer;  // links to it through older, nullptr for a rolled back version
+        std::shared_ptr<const RowChunk> chunk; // the version may live in its arena
+        std::unique_ptr<RowVersion> version;
+    };
+    std::deque<RetiredVersion> retired_; // in commit order, freed once no snapshot can see them
+    std::set<size_t> deleted_chunks_;    // chunks that lost rows, dropped once all of their rows are garbage
+
+    RowVersion* newest(RowId slot) const;
+    const Row* newestRow(RowId slot) const; // nullptr for a deleted row
+    void replace(RowId slot, std::unique_ptr<RowVersion> version);
+    void publish(std::shared_ptr<const RowChunkList> chunks);
+    void markUnsorted(const std::string& column);
+    void encode(Row& row) const;
+    bool droppable(const RowChunk& chunk, uint64_t horizon) const;
+    void newSchemaVersion();
 
 public:
     explicit Table(std::string name);
@@ -35,10 +89,41 @@ public:
     void dropColumn(const std::string& name);
     void renameColumn(const std::string& old_name, const std::string& new_name);
 
+    // the rows as snapshot sees them
+    RowView rows(const Snapshot& snapshot) const;
+    // the newest rows, uncommitted ones included. for writers holding the latch
+    RowView rows() const;
+
+    // writes, the caller holds the latch exclusively. slots come from rows()
     void addRow(const Row& r);
-    const RowList& getRows() const;
-    Row& getRow(size_t index);
-    size_t rowCount() const;
+    void updateRow(RowId slot, const std::unordered_map<std::string, Value>& values);
+    void deleteRow(RowId slot);
+    void clearRows();
+    size_t rowCount() const; // newest rows that aren't deleted
+    bool isSortedBy(const std::string& column) const;
+    // the dictionary of a STRING column, nullptr for any other
+    const StringDictionary* dictionary(const std::string& column) const;
+
+    // bytes the table takes, for SHOW MEMORY. readable while the writer goes on
+    struct MemoryUse {
+        size_t rows = 0;  // chunk arenas and versions written by UPDATE, old ones not collected yet too
+        size_t index = 0; // slot arrays, validity bitmaps and zone maps of the chunks
+        // per column in column order, for the newest versions: an estimate of what their values
+        // take in the rows (part of rows above) and Value::payloadSize() summed up
+        std::vector<size_t> column_allocated;
+        std::vector<size_t> column_payload;
+    };
+    MemoryUse memoryUse() const;
+
+    // makes the versions written since the last commit visible at timestamp
+    void commit(uint64_t timestamp);
+    // the current end of the undo log, rollback() goes back to it
+    size_t savepoint() const;
+    // undoes the writes made after savepoint. committed is the newest commit timestamp, snapshots
+    // up to it may still be looking at the undone versions so they are freed once those are gone
+    void rollback(size_t savepoint, uint64_t committed);
+    // frees versions no snapshot at or after horizon can see
+    void collect(uint64_t horizon);
 
     void addConstraint(ConstraintPtr c);
     const ConstraintList& getConstraints() const;
@@ -50,10 +135,11 @@ public:
     bool validateRow(const Row& row) const;
 
     void clear();
-    void clearRows();
 
     ConstraintPtr getPrimaryKeyConstraint() const;
     std::vector<std::string> getPrimaryKeyColumns() const;
+
+    std::shared_timed_mutex& latch() const;
 };
 
 #endif //TABLE_H
@@ -4,51 +4,212 @@
 
 #include "Value.hpp"
 
-#include <iomanip>
+#include <charconv>
 #include <format>
+#include <new>
 
 Value Value::Null() {
     return Value();
 }
 
-bool Value::isNull() const {
-    return std::holds_alternative<std::monostate>(value);
+Value::HeapString* Value::HeapString::make(std::string_view s) {
+    void* memory = ::operator new(sizeof(HeapString) + s.size());
+    auto* string = new (memory) HeapString{{1}, static_cast<uint32_t>(s.size()), 0};
+    std::memcpy(reinterpret_cast<char*>(string + 1), s.data(), s.size());
+    return string;
 }
 
-DataType Value::getType() const {
-    if (isNull()) return DataType::NULL_VALUE;
-    if (std::holds_alternative<int>(value)) return DataType::INTEGER;
-    if (std::holds_alternative<double>(value)) return DataType::FLOAT;
-    if (std::holds_alternative<bool>(value)) return DataType::BOOLEAN;
-    if (std::holds_alternative<std::string>(value)) return DataType::STRING;
-    if (std::holds_alternative<Date>(value)) return DataType::DATE;
-    if (std::holds_alternative<DateTime>(value)) return DataType::DATETIME;
-    throw std::runtime_error("unknown type in Value");
+void Value::release() {
+    if (!onHeap()) return;
+    HeapString* string = heap();
+    // acq_rel: whoever frees it sees every other owner done with it
+    if (string->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        string->~HeapString();
+        ::operator delete(string);
+    }
+    type_ = DataType::NULL_VALUE;
 }
 
-std::string Value::toString() const {
-    if (isNull()) return "NULL";
-    // apply lambda to the whatever type is in value
-    return std::visit([](auto&& arg) -> std::string {
-        // deduct the type, and remove references
-        using T = std::decay_t<decltype(arg)>;
-
-        if constexpr (std::is_same_v<T, int>) {
-            return std::to_string(arg);
-        } else if constexpr (std::is_same_v<T, double>) {
-            std::ostringstream oss; // fixed (no scientific), prec 6 output stream
-            oss << std::fixed << std::setprecision(6) << arg;
-            return oss.str();
-        } else if constexpr (std::is_same_v<T, bool>) {
-            return arg ? "true" : "false";
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            return arg;
-        } else if constexpr (std::is_same_v<T, Date>) {
-            return std::format("{:%Y-%m-%d}", arg);
-        } else if constexpr (std::is_same_v<T, DateTime>) {
-            return std::format("{:%Y-%m-%d %H:%M:%S}", arg);
-        } else {
-            throw std::runtime_error("unsupported type in Value::toString");
+void Value::setString(std::string_view s) {
+    type_ = DataType::STRING;
+    if (s.size() <= SMALL_CAPACITY) {
+        std::memcpy(payload_, s.data(), s.size());
+        size_ = static_cast<uint8_t>(s.size());
+        return;
+    }
+    HeapString* string = HeapString::make(s);
+    std::memcpy(payload_, &string, sizeof(string));
+    size_ = ON_HEAP;
+}
+
+std::string_view Value::view() const {
+    if (size_ >= CODED) {
+        HeapString* string = heap();
+        return std::string_view(string->data(), string->size);
+    }
+    return std::string_view(payload_, size_);
+}
+
+bool Value::operator==(const Value& o) const {
+    if (type_ != o.type_) return false; // also one NULL and one not
+    switch (type_) {
+        case DataType::NULL_VALUE: return true;
+        case DataType::INTEGER: return load<int>() == o.load<int>();
+        case DataType::FLOAT: return load<double>() == o.load<double>();
+        case DataType::BOOLEAN: return load<bool>() == o.load<bool>();
+        case DataType::STRING:
+            // codes of one dictionary are equal exactly when the strings are
+            if (isCoded() && o.isCoded() && dictionary() == o.dictionary()) return code() == o.code();
+            return view() == o.view();
+        case DataType::DATE: return load<Date>() == o.load<Date>();
+        case DataType::DATETIME: return load<DateTime>() == o.load<DateTime>();
+    }
+    return false;
+}
+
+bool Value::operator<(const Value& o) const {
+    if (isNull() || o.isNull()) return false;
+    if (type_ != o.type_) {
+        throw std::runtime_error("cannot compare values of different types");
+    }
+    switch (type_) {
+        case DataType::INTEGER: return load<int>() < o.load<int>();
+        case DataType::FLOAT: return load<double>() < o.load<double>();
+        case DataType::BOOLEAN: return load<bool>() < o.load<bool>();
+        case DataType::STRING: return view() < o.view();
+        case DataType::DATE: return load<Date>() < o.load<Date>();
+        case DataType::DATETIME: return load<DateTime>() < o.load<DateTime>();
+        default: return false;
+    }
+}
+
+std::size_t Value::hash() const {
+    switch (type_) {
+        case DataType::INTEGER: return std::hash<int>{}(load<int>());
+        case DataType::FLOAT: return std::hash<double>{}(load<double>());
+        case DataType::BOOLEAN: return std::hash<bool>{}(load<bool>());
+        case DataType::STRING:
+            if (isCoded()) return heap()->hash;
+            return std::hash<std::string_view>{}(view());
+        case DataType::DATE:
+            return std::hash<int>{}(std::chrono::sys_days(load<Date>()).time_since_epoch().count());
+        case DataType::DATETIME:
+            return std::hash<long long>{}(load<DateTime>().time_since_epoch().count());
+        default:
+            return 0;
+    }
+}
+
+// n as exactly width digits
+static char* writeDigits(char* p, unsigned n, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        p[i] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    }
+    return p + width;
+}
+
+// YYYY-MM-DD, false for years std::format writes some other way
+static bool writeDate(char*& p, int year, unsigned month, unsigned day) {
+    if (year < 0 || year > 9999 || month > 99 || day > 99) return false;
+    p = writeDigits(p, year, 4);
+    *p++ = '-';
+    p = writeDigits(p, month, 2);
+    *p++ = '-';
+    p = writeDigits(p, day, 2);
+    return true;
+}
+
+void Value::appendTo(std::string& out) const {
+    switch (type_) {
+        case DataType::NULL_VALUE:
+            out += "NULL";
+            return;
+        case DataType::INTEGER: {
+            char buffer[16];
+            auto end = std::to_chars(buffer, buffer + sizeof(buffer), load<int>()).ptr;
+            out.append(buffer, end);
+            return;
+        }
+        case DataType::FLOAT: {
+            // fixed (no scientific), prec 6, the same as printf's %f. the largest double has 309 digits
+            char buffer[400];
+            auto end = std::to_chars(buffer, buffer + sizeof(buffer), load<double>(), std::chars_format::fixed, 6).ptr;
+            out.append(buffer, end);
+            return;
         }
-    }, value);
+        case DataType::BOOLEAN:
+            out += load<bool>() ? "true" : "false";
+            return;
+        case DataType::STRING:
+            out += view();
+            return;
+        case DataType::DATE: {
+            auto date = load<Date>();
+            char buffer[16];
+            char* p = buffer;
+            if (writeDate(p, int(date.year()), unsigned(date.month()), unsigned(date.day()))) {
+                out.append(buffer, p);
+            } else {
+                out += std::format("{:%Y-%m-%d}", date);
+            }
+            return;
+        }
+        case DataType::DATETIME: {
+            auto time = load<DateTime>();
+            auto day = std::chrono::floor<std::chrono::days>(time);
+            Date date(day);
+            auto ms = static_cast<unsigned>((time - day).count()); // into the day, never negative
+            char buffer[32];
+            char* p = buffer;
+            if (writeDate(p, int(date.year()), unsigned(date.month()), unsigned(date.day()))) {
+                // %S of a millisecond time has the milliseconds after the seconds
+                *p++ = ' ';
+                p = writeDigits(p, ms / 3600000, 2);
+                *p++ = ':';
+                p = writeDigits(p, ms / 60000 % 60, 2);
+                *p++ = ':';
+                p = writeDigits(p, ms / 1000 % 60, 2);
+                *p++ = '.';
+                p = writeDigits(p, ms % 1000, 3);
+                out.append(buffer, p);
+            } else {
+                out += std::format("{:%Y-%m-%d %H:%M:%S}", time);
+            }
+            return;
+        }
+    }
+    throw std::runtime_error("unsupported type in Value::toString");
+}
+
+std::size_t Value::payloadSize() const {
+    switch (type_) {
+        case DataType::INTEGER: return sizeof(int);
+        case DataType::FLOAT: return sizeof(double);
+        case DataType::BOOLEAN: return sizeof(bool);
+        case DataType::STRING: return view().size();
+        case DataType::DATE: return sizeof(Date);
+        case DataType::DATETIME: return sizeof(DateTime);
+        default: return 0;
+    }
+}
+
+std::string Value::toString() const {
+    std::string out;
+    appendTo(out);
+    return out;
+}
+
+std::size_t CompositeKeyHash::operator()(const CompositeKey& key) const {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (const auto& v : key) {
+        h ^= v.hash() + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    // std::hash<int> is the identity, mix so the top bits are usable for partitioning
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
 }
@@ -4,23 +4,125 @@
 #ifndef VALUE_H
 #define VALUE_H
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 #include "data_types.hpp"
 
+class StringDictionary;
+
+// 16 bytes: the payload, a string of up to SMALL_CAPACITY characters inline or a pointer to a
+// shared immutable one on the heap, then the type. copying never allocates, a long string only
+// gets its reference count bumped.
+// a string stored in a dictionary encoded column (see Dictionary.hpp) is always on the heap and
+// carries its code and dictionary next to the pointer, two of them compare by code
 class Value {
+    friend class StringDictionary;
+
+public:
+    static constexpr size_t SMALL_CAPACITY = 14;
+
 private:
-    VariantType value;
+    // a long string, the characters follow the header in the same allocation
+    struct HeapString {
+        std::atomic<uint32_t> refs;
+        uint32_t size;
+        size_t hash; // of the characters, only filled in for dictionary strings
+
+        const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+        static HeapString* make(std::string_view s);
+    };
+    static constexpr uint8_t ON_HEAP = 0xff; // size_ of a long string
+    static constexpr uint8_t CODED = 0xfe;   // size_ of a dictionary string
+    // where a dictionary string keeps its code and dictionary, after the pointer
+    static constexpr size_t CODE_OFFSET = sizeof(HeapString*);
+    static constexpr size_t DICTIONARY_OFFSET = CODE_OFFSET + sizeof(uint16_t);
+
+    alignas(8) char payload_[SMALL_CAPACITY] = {};
+    uint8_t size_ = 0; // length of an inline string
+    DataType type_ = DataType::NULL_VALUE;
+
+    template<typename T>
+    static constexpr DataType typeOf() {
+        if constexpr (std::is_same_v<T, int>) return DataType::INTEGER;
+        else if constexpr (std::is_same_v<T, double>) return DataType::FLOAT;
+        else if constexpr (std::is_same_v<T, bool>) return DataType::BOOLEAN;
+        else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) return DataType::STRING;
+        else if constexpr (std::is_same_v<T, Date>) return DataType::DATE;
+        else if constexpr (std::is_same_v<T, DateTime>) return DataType::DATETIME;
+        else static_assert(sizeof(T) == 0, "not a Value type");
+    }
+
+    template<typename T>
+    Value(DataType type, const T& v) : type_(type) {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= SMALL_CAPACITY);
+        std::memcpy(payload_, &v, sizeof(T));
+    }
+    template<typename T>
+    T load() const {
+        T v;
+        std::memcpy(&v, payload_, sizeof(T));
+        return v;
+    }
+
+    HeapString* heap() const { return load<HeapString*>(); }
+    bool onHeap() const { return type_ == DataType::STRING && size_ >= CODED; }
+    uint32_t dictionary() const {
+        uint32_t id;
+        std::memcpy(&id, payload_ + DICTIONARY_OFFSET, sizeof(id));
+        return id;
+    }
+    void retain() const {
+        if (onHeap()) heap()->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release();
+    void setString(std::string_view s);
+    std::string_view view() const;
 
 public:
-    Value() : value(std::monostate{}){} // use null as default
-    explicit Value(int v) : value(v){}
-    explicit Value(double v) : value(v){}
-    explicit Value(bool v) : value(v){}
-    explicit Value(const std::string& v) : value(v){}
-    explicit Value(const char* v) : value(std::string(v)){} // for inline Value("adasd") definition
-    explicit Value(const Date& v) : value(v){}
-    explicit Value(const DateTime& v) : value(v){}
-    Value(const Value& other) = default; // copy constructor
-    Value& operator=(const Value& other) = default; // assignment operator
+    Value() = default; // use null as default
+    explicit Value(int v) : Value(DataType::INTEGER, v) {}
+    explicit Value(double v) : Value(DataType::FLOAT, v) {}
+    explicit Value(bool v) : Value(DataType::BOOLEAN, v) {}
+    explicit Value(std::string_view v) { setString(v); }
+    explicit Value(const std::string& v) { setString(v); }
+    explicit Value(const char* v) { setString(v); } // for inline Value("adasd") definition
+    explicit Value(const Date& v) : Value(DataType::DATE, v) {}
+    explicit Value(const DateTime& v) : Value(DataType::DATETIME, v) {}
+
+    Value(const Value& other) : size_(other.size_), type_(other.type_) {
+        std::memcpy(payload_, other.payload_, SMALL_CAPACITY);
+        retain();
+    }
+    Value(Value&& other) noexcept : size_(other.size_), type_(other.type_) {
+        std::memcpy(payload_, other.payload_, SMALL_CAPACITY);
+        other.type_ = DataType::NULL_VALUE; // the string is ours now
+    }
+    Value& operator=(const Value& other) {
+        other.retain(); // first, other may share the string with this
+        release();
+        std::memcpy(payload_, other.payload_, SMALL_CAPACITY);
+        size_ = other.size_;
+        type_ = other.type_;
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::memcpy(payload_, other.payload_, SMALL_CAPACITY);
+            size_ = other.size_;
+            type_ = other.type_;
+            other.type_ = DataType::NULL_VALUE;
+        }
+        return *this;
+    }
+    ~Value() { release(); }
 
     /*
     Value v1;
@@ -28,42 +130,57 @@ public:
     v1.isNull() == v2.isNull();
     */
     static Value Null();
-    bool isNull() const;
-    DataType getType() const;
+    bool isNull() const { return type_ == DataType::NULL_VALUE; }
+    DataType getType() const { return type_; }
     std::string toString() const;
+    // toString() added to the end of out, without a string of its own for every value
+    void appendTo(std::string& out) const;
+    std::size_t hash() const; // consistent with operator==, used for GROUP BY and join keys
+    // bytes of data: the characters of a string, the size of the C++ type of anything else
+    std::size_t payloadSize() const;
+    // bytes of the long string this value points at, shared by its copies. 0 for anything else
+    // and for a dictionary string, which its dictionary accounts for
+    std::size_t heapSize() const { return onHeap() && !isCoded() ? sizeof(HeapString) + heap()->size : 0; }
+    bool isCoded() const { return type_ == DataType::STRING && size_ == CODED; }
+    uint16_t code() const { // position in its dictionary, only for isCoded()
+        uint16_t c;
+        std::memcpy(&c, payload_ + CODE_OFFSET, sizeof(c));
+        return c;
+    }
 
-    // templates need to be in headers
+    // get<std::string_view>() reads a string without copying it, the view lives as long as the value
     template<typename T>
     T get() const {
-        try {
-            return std::get<T>(value);
-        } catch (const std::bad_variant_access&) {
+        if (type_ != typeOf<T>()) {
             throw std::runtime_error("invalid type access in Value");
         }
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(view());
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
+            return view();
+        } else {
+            return load<T>();
+        }
     }
 
-    // operators
-    bool operator==(const Value& o) const {
-        if (isNull() && o.isNull()) return true;
-        if (isNull() || o.isNull()) return false;
-        return value == o.value;
+    // get<T>() for a caller that checked getType() already: no check, nothing thrown
+    template<typename T>
+    T getUnchecked() const {
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return view();
+        } else {
+            return load<T>();
+        }
     }
 
+    // operators
+    bool operator==(const Value& o) const;
+
     bool operator!=(const Value& o) const {
         return !(*this == o);
     }
 
-    bool operator<(const Value& o) const {
-        if (isNull() || o.isNull()) return false;
-        return std::visit([](const auto& a, const auto& b) -> bool {
-            using A = std::decay_t<decltype(a)>;
-            using B = std::decay_t<decltype(b)>;
-            if constexpr (std::is_same_v<A, B>) {
-                return a < b;
-            }
-            throw std::runtime_error("cannot compare values of different types");
-        }, value, o.value);
-    }
+    bool operator<(const Value& o) const;
 
     bool operator>(const Value& o) const {
         return o < *this;
@@ -78,4 +195,13 @@ public:
     }
 };
 
+static_assert(sizeof(Value) == 16);
+
+// multi-column key of hash based operators (GROUP BY, joins)
+using CompositeKey = std::vector<Value>;
+
+struct CompositeKeyHash {
+    std::size_t operator()(const CompositeKey& key) const;
+};
+
 #endif //VALUE_H
@@ -0,0 +1,53 @@
+// compares the single-threaded and the parallel hash aggregation on a synthetic table
+//
+// usage: db_bench [rows] [groups] [threads]
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <fmt/format.h>
+
+#include "Aggregate.hpp"
+#include "Table.hpp"
+
+template<typename F>
+static auto timeMs(F&& f) -> double {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+    int groups = argc > 2 ? std::stoi(argv[2]) : 1000;
+    size_t threads = argc > 3 ? std::stoull(argv[3]) : std::thread::hardware_concurrency();
+
+    Table table("bench", {Column("k", DataType::INTEGER), Column("v", DataType::FLOAT)});
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, groups - 1);
+    std::uniform_real_distribution<double> val_dist(0.0, 100.0);
+    for (size_t i = 0; i < rows; i++) {
+        Row row;
+        row.setValue("k", Value(key_dist(rng)));
+        row.setValue("v", Value(val_dist(rng)));
+        table.addRow(row);
+    }
+
+    HashAggregator aggregator({"k"}, {
+        {AggregateFunction::COUNT, "*"},
+        {AggregateFunction::SUM, "v"},
+        {AggregateFunction::MAX, "v"},
+    });
+
+    size_t single_groups = 0, parallel_groups = 0;
+    double single_ms = timeMs([&] { single_groups = aggregator.aggregate(table.rows()).size(); });
+    double parallel_ms = timeMs([&] { parallel_groups = aggregator.aggregateParallel(table.rows(), nullptr, threads).size(); });
+
+    fmt::print("rows: {}, groups: {}, threads: {}\n", rows, groups, threads);
+    fmt::print("single-threaded: {:.1f} ms ({} groups)\n", single_ms, single_groups);
+    fmt::print("parallel:        {:.1f} ms ({} groups)\n", parallel_ms, parallel_groups);
+    fmt::print("speedup:         {:.2f}x\n", single_ms / parallel_ms);
+    return single_groups == parallel_groups ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// load generator for db_cpp --serve: N connections, each on its own thread, sending point lookups
+// (or any statement with {} where a random key goes) and timing every request. with --pipeline D
+// every connection keeps D requests in flight, --columnar asks for binary results and decodes them
+//
+// usage: db_load_client [--socket PATH | --host HOST --port PORT] [--connections N]
+//                       [--requests N] [--rows N] [--pipeline D] [--columnar]
+//                       [--query "SELECT ... {}"]
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Client.hpp"
+#include "Columnar.hpp"
+#include "Server.hpp"
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    uint16_t port = ServerOptions::DEFAULT_PORT;
+    std::string socket_path; // wins over TCP when set
+    size_t connections = 4;
+    size_t requests = 20'000; // per connection
+    size_t rows = 1000;
+    size_t pipeline = 1; // requests in flight per connection
+    ResultFormat format = ResultFormat::TEXT;
+    std::string query = "SELECT id, name FROM load_test WHERE id = {}";
+};
+
+static auto connect(const LoadOptions& options) -> Client {
+    if (!options.socket_path.empty()) return Client::connectUnix(options.socket_path);
+    return Client::connectTcp(options.host, options.port);
+}
+
+// creates and fills load_test unless it is there already
+static auto setup(const LoadOptions& options) -> void {
+    auto client = connect(options);
+    if (client.query("CREATE TABLE load_test (id INTEGER, name STRING)").status != ResponseStatus::OK) {
+        return;
+    }
+    const size_t batch = 500;
+    for (size_t start = 0; start < options.rows; start += batch) {
+        std::string insert = "INSERT INTO load_test VALUES ";
+        for (size_t id = start; id < std::min(options.rows, start + batch); id++) {
+            if (id != start) insert += ", ";
+            insert += fmt::format("({}, 'name{}')", id, id);
+        }
+        client.query(insert);
+    }
+}
+
+static auto substitute(const std::string& query, size_t key) -> std::string {
+    auto pos = query.find("{}");
+    if (pos == std::string::npos) return query;
+    return query.substr(0, pos) + std::to_string(key) + query.substr(pos + 2);
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--columnar") {
+            options.format = ResultFormat::COLUMNAR;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fmt::print(stderr, "missing value for {}\n", flag);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--host") options.host = value;
+        else if (flag == "--port") options.port = static_cast<uint16_t>(std::stoul(value));
+        else if (flag == "--socket") options.socket_path = value;
+        else if (flag == "--connections") options.connections = std::stoull(value);
+        else if (flag == "--requests") options.requests = std::stoull(value);
+        else if (flag == "--rows") options.rows = std::stoull(value);
+        else if (flag == "--pipeline") options.pipeline = std::max<size_t>(1, std::stoull(value));
+        else if (flag == "--query") options.query = value;
+        else {
+            fmt::print(stderr, "unknown option {}\n", flag);
+            return 1;
+        }
+    }
+
+    try {
+        setup(options);
+    } catch (const std::exception& e) {
+        fmt::print(stderr, "setup failed: {}\n", e.what());
+        return 1;
+    }
+
+    std::vector<std::vector<double>> latencies(options.connections); // microseconds
+    std::vector<size_t> errors(options.connections, 0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < options.connections; c++) {
+        threads.emplace_back([&, c] {
+            try {
+                auto client = connect(options);
+                std::mt19937_64 rng(c);
+                std::uniform_int_distribution<size_t> key(0, options.rows ? options.rows - 1 : 0);
+                latencies[c].reserve(options.requests);
+                std::deque<std::chrono::steady_clock::time_point> in_flight;
+
+                auto receive = [&] {
+                    auto response = client.receive();
+                    auto received = std::chrono::steady_clock::now();
+                    latencies[c].push_back(std::chrono::duration<double, std::micro>(received - in_flight.front()).count());
+                    in_flight.pop_front();
+                    if (response.status != ResponseStatus::OK) errors[c]++;
+                    if (options.format == ResultFormat::COLUMNAR) decodeColumnar(response.body);
+                };
+
+                for (size_t r = 0; r < options.requests; r++) {
+                    client.send(substitute(options.query, key(rng)), options.format);
+                    in_flight.push_back(std::chrono::steady_clock::now());
+                    if (in_flight.size() == options.pipeline) receive();
+                }
+                while (!in_flight.empty()) receive();
+            } catch (const std::exception& e) {
+                fmt::print(stderr, "connection {}: {}\n", c, e.what());
+                errors[c]++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    size_t error_count = 0;
+    for (size_t c = 0; c < options.connections; c++) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        error_count += errors[c];
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+    };
+
+    fmt::print("connections: {}, pipeline: {}, format: {}, requests: {}, errors: {}\n", options.connections,
+               options.pipeline, options.format == ResultFormat::COLUMNAR ? "columnar" : "text", all.size(), error_count);
+    fmt::print("throughput: {:.0f} requests/s\n", all.size() / seconds);
+    fmt::print("latency: p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us\n",
+               percentile(0.50), percentile(0.99), all.empty() ? 0.0 : all.back());
+    return error_count == 0 ? 0 : 1;
+}
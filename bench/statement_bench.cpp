@@ -0,0 +1,141 @@
+// statements per second on trivial queries, a fresh Parser + Executor per statement
+// against one long-lived Session, against prepared statements and against the plan cache
+// on ad-hoc statements that only differ in their literals
+//
+// usage: db_statement_bench [statements]
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "Database.hpp"
+#include "Executor.hpp"
+#include "Parser.hpp"
+#include "Session.hpp"
+
+template<typename F>
+static auto timeMs(F&& f) -> double {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// the executor prints results, keep them out of the measurement output
+class SilenceStdout {
+private:
+    int saved_;
+
+public:
+    SilenceStdout() {
+        std::fflush(stdout);
+        saved_ = dup(STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    ~SilenceStdout() {
+        std::fflush(stdout);
+        dup2(saved_, STDOUT_FILENO);
+        close(saved_);
+    }
+};
+
+int main(int argc, char** argv) {
+    size_t statements = argc > 1 ? std::stoull(argv[1]) : 200'000;
+
+    const std::vector<std::string> queries = {
+        "SELECT id, name FROM t WHERE id = 1",
+        "SELECT COUNT(*) FROM t",
+        "UPDATE t SET name = 'b' WHERE id = 2",
+        "SHOW TABLES",
+    };
+
+    Database db("bench");
+    {
+        Session setup(db);
+        SilenceStdout quiet;
+        setup.execute(setup.parse("CREATE TABLE t (id INTEGER, name STRING)"));
+        setup.execute(setup.parse("INSERT INTO t VALUES (1, 'a'), (2, 'b'), (3, 'c')"));
+    }
+
+    size_t parsed = 0;
+    auto report = [&](const char* name, double ms) {
+        fmt::print("{:<28} {:>8.1f} ms  {:>12.0f} statements/s\n", name, ms, statements / (ms / 1000.0));
+    };
+
+    double fresh_parse = timeMs([&] {
+        for (size_t i = 0; i < statements; i++) {
+            Parser parser;
+            parsed += parser.parse(queries[i % queries.size()]) != nullptr;
+        }
+    });
+
+    Session session(db);
+    double session_parse = timeMs([&] {
+        for (size_t i = 0; i < statements; i++) {
+            parsed += session.parse(queries[i % queries.size()]) != nullptr;
+        }
+    });
+
+    auto select = session.prepare("SELECT id, name FROM t WHERE id = $1");
+    auto update = session.prepare("UPDATE t SET name = $1 WHERE id = $2");
+    const std::vector<Value> select_params = {Value(1)};
+    const std::vector<Value> update_params = {Value("b"), Value(2)};
+
+    // the same two statements with changing constants, like a dashboard sends them
+    std::vector<std::string> adhoc;
+    for (size_t i = 0; i < 1000; i++) {
+        if (i % 2) adhoc.push_back(fmt::format("SELECT id, name FROM t WHERE id = {}", i % 3 + 1));
+        else adhoc.push_back(fmt::format("UPDATE t SET name = 'n{}' WHERE id = {}", i, i % 3 + 1));
+    }
+
+    double fresh_exec, session_exec, prepared_exec, adhoc_exec, cached_exec;
+    {
+        SilenceStdout quiet;
+        fresh_exec = timeMs([&] {
+            for (size_t i = 0; i < statements; i++) {
+                Parser parser;
+                Executor executor(db);
+                executor.execute(parser.parse(queries[i % queries.size()]));
+            }
+        });
+        session_exec = timeMs([&] {
+            for (size_t i = 0; i < statements; i++) {
+                session.execute(session.parse(queries[i % queries.size()]));
+            }
+        });
+        prepared_exec = timeMs([&] {
+            for (size_t i = 0; i < statements; i++) {
+                if (i % 2) session.execute(*select, select_params);
+                else session.execute(*update, update_params);
+            }
+        });
+        adhoc_exec = timeMs([&] {
+            for (size_t i = 0; i < statements; i++) {
+                session.execute(session.parse(adhoc[i % adhoc.size()]));
+            }
+        });
+        cached_exec = timeMs([&] {
+            for (size_t i = 0; i < statements; i++) {
+                session.run(adhoc[i % adhoc.size()]);
+            }
+        });
+    }
+
+    fmt::print("statements: {}\n", statements);
+    report("parse, fresh parser:", fresh_parse);
+    report("parse, session:", session_parse);
+    report("parse + execute, fresh:", fresh_exec);
+    report("parse + execute, session:", session_exec);
+    report("prepared SELECT/UPDATE:", prepared_exec);
+    report("ad-hoc, parse + execute:", adhoc_exec);
+    report("ad-hoc, plan cache:", cached_exec);
+    const auto& cache = session.getPlanCache();
+    fmt::print("plan cache: {} hits, {} misses, {} entries\n", cache.getHits(), cache.getMisses(), cache.size());
+    return parsed == 2 * statements ? 0 : 1;
+}
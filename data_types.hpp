@@ -5,6 +5,7 @@
 #ifndef DATA_TYPES_H
 #define DATA_TYPES_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <chrono>
@@ -18,7 +19,7 @@ enum class ConstraintType {
     DEFAULT,
 };
 
-enum class DataType {
+enum class DataType : uint8_t {
     INTEGER,
     FLOAT,
     BOOLEAN,
@@ -36,17 +37,6 @@ using Date = std::chrono::year_month_day;
 using DateTime = std::chrono::sys_time<std::chrono::milliseconds>;  
 
 
-// type safety, corresponding types are self-explanatory
-using VariantType = std::variant<
-    int,
-    double,
-    bool,
-    std::string,
-    Date,
-    DateTime,
-    std::monostate // for NULL
->;
-
 inline auto dataTypeToString(const DataType& t) -> std::string {
     const std::unordered_map<DataType, std::string> tmap = {
         {DataType::INTEGER, "INTEGER"},
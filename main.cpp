@@ -1,68 +1,78 @@
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <fmt/base.h>
 #include <string>
 #include <signal.h>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
 
 #include "Row.hpp"
 #include "Value.hpp"
 #include "Parser.hpp"
 #include "Executor.hpp"
 #include "Database.hpp"
+#include "Session.hpp"
+#include "Script.hpp"
+#include "Server.hpp"
 
 const std::string COMMAND_LOG_FILE = "db_commands.log";
 Database* globalDb = nullptr;
+Server* globalServer = nullptr;
 
-void logCommand(const std::string& command) {
-    std::ofstream logFile(COMMAND_LOG_FILE, std::ios::app);
+void logCommands(const std::vector<std::string>& commands) {
+    // opened once, a script can log thousands of statements
+    static std::ofstream logFile(COMMAND_LOG_FILE, std::ios::app);
+    static std::mutex logMutex; // server threads log concurrently
+    std::lock_guard lock(logMutex);
     if (logFile.is_open()) {
-        logFile << command << std::endl;
-        logFile.close();
+        // the log is replayed line by line, server clients can send statements spanning lines
+        for (const auto& command : commands) {
+            std::string line = command;
+            std::replace(line.begin(), line.end(), '\n', ' ');
+            std::replace(line.begin(), line.end(), '\r', ' ');
+            logFile << line << '\n';
+        }
+        logFile.flush(); // a whole transaction goes out in one write
     } else {
         fmt::println("Error: Could not open log file for writing");
     }
 }
 
 void signalHandler(int signum) {
+    if (globalServer) {
+        globalServer->stop(); // run() returns and the server cleans up its unix socket
+        return;
+    }
     if (globalDb) {
         fmt::println("\nExiting database...");
     }
     exit(signum);
 }
 
-void executeQuery(Database& db, const std::string& query, bool logToFile = true) {
-    Parser parser(db);
-    auto command = parser.parse(query);
-
-    if (command) {
-        Executor executor(db);
-        bool success = executor.execute(command);
+// the session logs commands that execute successfully and aren't read-only operations
+void executeQuery(Session& session, const std::string& query) {
+    auto result = session.run(query);
 
-        // only log commands that execute successfully and aren't read-only operations
-        if (success && logToFile && command->getType() != CommandType::SELECT && 
-            command->getType() != CommandType::SHOW && command->getType() != CommandType::HELP) {
-            logCommand(query);
-        }
-    } else {
+    if (!result.parsed) {
         fmt::println("failed to parse query: {}", query);
     }
     fmt::println("---");
 }
 
-bool rebuildDatabaseFromLog(Database& db) {
+// runs before the session gets its logger, so the commands aren't logged again
+bool rebuildDatabaseFromLog(Session& session) {
     std::ifstream logFile(COMMAND_LOG_FILE);
     if (!logFile.is_open()) {
         return false;
     }
 
-    std::string command;
-    while (std::getline(logFile, command)) {
-        if (!command.empty()) {
-            executeQuery(db, command, false); // don't log these commands again
-        }
-    }
-
-    logFile.close();
+    ScriptRunner runner(session);
+    runner.run(logFile, StatementReader::Mode::LINE);
+    session.rollback(); // a transaction whose COMMIT never made it into the log
     return true;
 }
 
@@ -121,18 +131,84 @@ bool rebuildDatabaseFromLog(Database& db) {
                "  - Exits the SQL interface"}
 */
 
-int main() {
+int main(int argc, char** argv) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
 
+    const char* script = nullptr;
+    bool serve = false;
+    ServerOptions server_options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) {
+            script = argv[++i];
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--host" && i + 1 < argc) {
+            server_options.host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            server_options.port = static_cast<uint16_t>(std::stoul(argv[++i]));
+        } else if (arg == "--socket" && i + 1 < argc) {
+            server_options.socket_path = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            server_options.threads = std::stoul(argv[++i]);
+        } else {
+            fmt::print(stderr, "usage: {} [-f script.sql] [--serve [--host HOST] [--port PORT] [--socket PATH] [--threads N]]\n", argv[0]);
+            return 1;
+        }
+    }
+
     Database db("test_db");
     globalDb = &db;
+    Session session(db); // one parser and executor for the whole REPL
+
+    // clients send statements over the network, --port 0 or --socket '' turn one of the listeners off
+    if (serve) {
+        rebuildDatabaseFromLog(session);
+        try {
+            Server server(db, server_options, logCommands);
+            server.start();
+            if (server_options.port != 0) {
+                fmt::println("listening on {}:{}", server_options.host, server_options.port);
+            }
+            if (!server_options.socket_path.empty()) {
+                fmt::println("listening on {}", server_options.socket_path);
+            }
+            std::fflush(stdout);
+            globalServer = &server;
+            server.run();
+            globalServer = nullptr;
+        } catch (const std::exception& e) {
+            fmt::print(stderr, "server error: {}\n", e.what());
+            return 1;
+        }
+        return 0;
+    }
 
-    if (rebuildDatabaseFromLog(db)) {
+    // a script file or piped stdin runs as one batch, without the banner and the --- separators
+    if (script || !isatty(STDIN_FILENO)) {
+        rebuildDatabaseFromLog(session);
+
+        std::ifstream file;
+        if (script) {
+            file.open(script);
+            if (!file.is_open()) {
+                fmt::print(stderr, "could not open script '{}'\n", script);
+                return 1;
+            }
+        }
+        session.setLogger(logCommands);
+        ScriptRunner runner(session);
+        size_t failed = runner.run(script ? file : std::cin, StatementReader::Mode::SEMICOLON);
+        return failed == 0 ? 0 : 1;
+    }
+
+    if (rebuildDatabaseFromLog(session)) {
         fmt::println("Successfully rebuilt database from command log.");
     } else {
         fmt::println("No existing command log found or error reading log. Starting with fresh database.");
     }
+    session.setLogger(logCommands);
 
     fmt::println("\nWelcome to SQL REPL. Type your SQL commands or 'exit' to quit.");
     fmt::println("Example commands:");
@@ -146,14 +222,16 @@ int main() {
     std::string input;
     while (true) {
         fmt::print("sql> ");
-        std::getline(std::cin, input);
-
-        if (input == "exit") {
+        if (!std::getline(std::cin, input) || input == "exit") {
             break;
         }
 
-        if (!input.empty()) {
-            executeQuery(db, input);
+        // a line can hold several ;-separated statements
+        std::istringstream line(input);
+        StatementReader reader(line, StatementReader::Mode::SEMICOLON);
+        std::string statement;
+        while (reader.next(statement)) {
+            executeQuery(session, statement);
         }
     }
 
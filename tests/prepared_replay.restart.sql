@@ -0,0 +1,3 @@
+SELECT * FROM t1;
+SELECT * FROM t2;
+exit;
@@ -0,0 +1,16 @@
+CREATE TABLE t1 (id INTEGER, x FLOAT, s STRING);
+CREATE TABLE t2 (id INTEGER, x FLOAT, s STRING);
+BEGIN;
+PREPARE ins AS INSERT INTO t1 (id, x, s) VALUES ($1, $2, $3);
+EXECUTE ins(1, 2, 'a');
+PREPARE ins AS INSERT INTO t2 (id, x, s) VALUES ($1, $2, $3);
+EXECUTE ins(2, 0.1, "it's");
+COMMIT;
+PREPARE up AS UPDATE t1 SET x = $1 WHERE id = $2;
+EXECUTE up(-2.5, 1);
+EXECUTE ins(3, 4, NULL);
+PREPARE del AS DELETE FROM t2 WHERE id = $1;
+EXECUTE del(2);
+SELECT * FROM t1;
+SELECT * FROM t2;
+exit;
@@ -0,0 +1,14 @@
+CREATE TABLE t (id INTEGER, k INTEGER);
+INSERT INTO t VALUES (0, 0), (1, 1), (2, 2), (3, 3), (4, 4), (5, 5), (6, 6), (7, 0), (8, 1), (9, 2), (10, 3), (11, 4), (12, 5), (13, 6), (14, 0), (15, 1), (16, 2), (17, 3), (18, 4), (19, 5), (20, 6), (21, 0), (22, 1), (23, 2), (24, 3), (25, 4), (26, 5), (27, 6), (28, 0), (29, 1), (30, 2), (31, 3), (32, 4), (33, 5), (34, 6), (35, 0), (36, 1), (37, 2), (38, 3), (39, 4), (40, 5), (41, 6), (42, 0), (43, 1), (44, 2), (45, 3), (46, 4), (47, 5), (48, 6), (49, 0), (50, 1), (51, 2), (52, 3), (53, 4), (54, 5), (55, 6), (56, 0), (57, 1), (58, 2), (59, 3), (60, 4), (61, 5), (62, 6), (63, 0), (64, 1), (65, 2), (66, 3), (67, 4), (68, 5), (69, 6), (70, 0), (71, 1), (72, 2), (73, 3), (74, 4), (75, 5), (76, 6), (77, 0), (78, 1), (79, 2), (80, 3), (81, 4), (82, 5), (83, 6), (84, 0), (85, 1), (86, 2), (87, 3), (88, 4), (89, 5), (90, 6), (91, 0), (92, 1), (93, 2), (94, 3), (95, 4), (96, 5), (97, 6), (98, 0), (99, 1), (100, 2), (101, 3), (102, 4), (103, 5), (104, 6), (105, 0), (106, 1), (107, 2), (108, 3), (109, 4), (110, 5), (111, 6), (112, 0), (113, 1), (114, 2), (115, 3), (116, 4), (117, 5), (118, 6), (119, 0), (120, 1), (121, 2), (122, 3), (123, 4), (124, 5), (125, 6), (126, 0), (127, 1), (128, 2), (129, 3), (130, 4), (131, 5), (132, 6), (133, 0), (134, 1), (135, 2), (136, 3), (137, 4), (138, 5), (139, 6), (140, 0), (141, 1), (142, 2), (143, 3), (144, 4), (145, 5), (146, 6), (147, 0), (148, 1), (149, 2), (150, 3), (151, 4), (152, 5), (153, 6), (154, 0), (155, 1), (156, 2), (157, 3), (158, 4), (159, 5), (160, 6), (161, 0), (162, 1), (163, 2), (164, 3), (165, 4), (166, 5), (167, 6), (168, 0), (169, 1), (170, 2), (171, 3), (172, 4), (173, 5), (174, 6), (175, 0), (176, 1), (177, 2), (178, 3), (179, 4), (180, 5), (181, 6), (182, 0), (183, 1), (184, 2), (185, 3), (186, 4), (187, 5), (188, 6), (189, 0), (190, 1), (191, 2), (192, 3), (193, 4), (194, 5), (195, 6), (196, 0), (197, 1), (198, 2), (199, 3), (200, 4), (201, 5), (202, 6), (203, 0), (204, 1), (205, 2), (206, 3), (207, 4), (208, 5), (209, 6), (210, 0), (211, 1), (212, 2), (213, 3), (214, 4), (215, 5), (216, 6), (217, 0), (218, 1), (219, 2), (220, 3), (221, 4), (222, 5), (223, 6), (224, 0), (225, 1), (226, 2), (227, 3), (228, 4), (229, 5), (230, 6), (231, 0), (232, 1), (233, 2), (234, 3), (235, 4), (236, 5), (237, 6), (238, 0), (239, 1), (240, 2), (241, 3), (242, 4), (243, 5), (244, 6), (245, 0), (246, 1), (247, 2), (248, 3), (249, 4), (250, 5), (251, 6), (252, 0), (253, 1), (254, 2), (255, 3), (256, 4), (257, 5), (258, 6), (259, 0), (260, 1), (261, 2), (262, 3), (263, 4), (264, 5), (265, 6), (266, 0), (267, 1), (268, 2), (269, 3), (270, 4), (271, 5), (272, 6), (273, 0), (274, 1), (275, 2), (276, 3), (277, 4), (278, 5), (279, 6), (280, 0), (281, 1), (282, 2), (283, 3), (284, 4), (285, 5), (286, 6), (287, 0), (288, 1), (289, 2), (290, 3), (291, 4), (292, 5), (293, 6), (294, 0), (295, 1), (296, 2), (297, 3), (298, 4), (299, 5), (300, 6), (301, 0), (302, 1), (303, 2), (304, 3), (305, 4), (306, 5), (307, 6), (308, 0), (309, 1), (310, 2), (311, 3), (312, 4), (313, 5), (314, 6), (315, 0), (316, 1), (317, 2), (318, 3), (319, 4), (320, 5), (321, 6), (322, 0), (323, 1), (324, 2), (325, 3), (326, 4), (327, 5), (328, 6), (329, 0), (330, 1), (331, 2), (332, 3), (333, 4), (334, 5), (335, 6), (336, 0), (337, 1), (338, 2), (339, 3), (340, 4), (341, 5), (342, 6), (343, 0), (344, 1), (345, 2), (346, 3), (347, 4), (348, 5), (349, 6), (350, 0), (351, 1), (352, 2), (353, 3), (354, 4), (355, 5), (356, 6), (357, 0), (358, 1), (359, 2), (360, 3), (361, 4), (362, 5), (363, 6), (364, 0), (365, 1), (366, 2), (367, 3), (368, 4), (369, 5), (370, 6), (371, 0), (372, 1), (373, 2), (374, 3), (375, 4), (376, 5), (377, 6), (378, 0), (379, 1), (380, 2), (381, 3), (382, 4), (383, 5), (384, 6), (385, 0), (386, 1), (387, 2), (388, 3), (389, 4), (390, 5), (391, 6), (392, 0), (393, 1), (394, 2), (395, 3), (396, 4), (397, 5), (398, 6), (399, 0), (400, 1), (401, 2), (402, 3), (403, 4), (404, 5), (405, 6), (406, 0), (407, 1), (408, 2), (409, 3), (410, 4), (411, 5), (412, 6), (413, 0), (414, 1), (415, 2), (416, 3), (417, 4), (418, 5), (419, 6), (420, 0), (421, 1), (422, 2), (423, 3), (424, 4), (425, 5), (426, 6), (427, 0), (428, 1), (429, 2), (430, 3), (431, 4), (432, 5), (433, 6), (434, 0), (435, 1), (436, 2), (437, 3), (438, 4), (439, 5), (440, 6), (441, 0), (442, 1), (443, 2), (444, 3), (445, 4), (446, 5), (447, 6), (448, 0), (449, 1), (450, 2), (451, 3), (452, 4), (453, 5), (454, 6), (455, 0), (456, 1), (457, 2), (458, 3), (459, 4), (460, 5), (461, 6), (462, 0), (463, 1), (464, 2), (465, 3), (466, 4), (467, 5), (468, 6), (469, 0), (470, 1), (471, 2), (472, 3), (473, 4), (474, 5), (475, 6), (476, 0), (477, 1), (478, 2), (479, 3), (480, 4), (481, 5), (482, 6), (483, 0), (484, 1), (485, 2), (486, 3), (487, 4), (488, 5), (489, 6), (490, 0), (491, 1), (492, 2), (493, 3), (494, 4), (495, 5), (496, 6), (497, 0), (498, 1), (499, 2), (500, 3), (501, 4), (502, 5), (503, 6), (504, 0), (505, 1), (506, 2), (507, 3), (508, 4), (509, 5), (510, 6), (511, 0), (512, 1), (513, 2), (514, 3), (515, 4), (516, 5), (517, 6), (518, 0), (519, 1), (520, 2), (521, 3), (522, 4), (523, 5), (524, 6), (525, 0), (526, 1), (527, 2), (528, 3), (529, 4), (530, 5), (531, 6), (532, 0), (533, 1), (534, 2), (535, 3), (536, 4), (537, 5), (538, 6), (539, 0), (540, 1), (541, 2), (542, 3), (543, 4), (544, 5), (545, 6), (546, 0), (547, 1), (548, 2), (549, 3), (550, 4), (551, 5), (552, 6), (553, 0), (554, 1), (555, 2), (556, 3), (557, 4), (558, 5), (559, 6), (560, 0), (561, 1), (562, 2), (563, 3), (564, 4), (565, 5), (566, 6), (567, 0), (568, 1), (569, 2), (570, 3), (571, 4), (572, 5), (573, 6), (574, 0), (575, 1), (576, 2), (577, 3), (578, 4), (579, 5), (580, 6), (581, 0), (582, 1), (583, 2), (584, 3), (585, 4), (586, 5), (587, 6), (588, 0), (589, 1), (590, 2), (591, 3), (592, 4), (593, 5), (594, 6), (595, 0), (596, 1), (597, 2), (598, 3), (599, 4), (600, 5), (601, 6), (602, 0), (603, 1), (604, 2), (605, 3), (606, 4), (607, 5), (608, 6), (609, 0), (610, 1), (611, 2), (612, 3), (613, 4), (614, 5), (615, 6), (616, 0), (617, 1), (618, 2), (619, 3), (620, 4), (621, 5), (622, 6), (623, 0), (624, 1), (625, 2), (626, 3), (627, 4), (628, 5), (629, 6), (630, 0), (631, 1), (632, 2), (633, 3), (634, 4), (635, 5), (636, 6), (637, 0), (638, 1), (639, 2), (640, 3), (641, 4), (642, 5), (643, 6), (644, 0), (645, 1), (646, 2), (647, 3), (648, 4), (649, 5), (650, 6), (651, 0), (652, 1), (653, 2), (654, 3), (655, 4), (656, 5), (657, 6), (658, 0), (659, 1), (660, 2), (661, 3), (662, 4), (663, 5), (664, 6), (665, 0), (666, 1), (667, 2), (668, 3), (669, 4), (670, 5), (671, 6), (672, 0), (673, 1), (674, 2), (675, 3), (676, 4), (677, 5), (678, 6), (679, 0), (680, 1), (681, 2), (682, 3), (683, 4), (684, 5), (685, 6), (686, 0), (687, 1), (688, 2), (689, 3), (690, 4), (691, 5), (692, 6), (693, 0), (694, 1), (695, 2), (696, 3), (697, 4), (698, 5), (699, 6), (700, 0), (701, 1), (702, 2), (703, 3), (704, 4), (705, 5), (706, 6), (707, 0), (708, 1), (709, 2), (710, 3), (711, 4), (712, 5), (713, 6), (714, 0), (715, 1), (716, 2), (717, 3), (718, 4), (719, 5), (720, 6), (721, 0), (722, 1), (723, 2), (724, 3), (725, 4), (726, 5), (727, 6), (728, 0), (729, 1), (730, 2), (731, 3), (732, 4), (733, 5), (734, 6), (735, 0), (736, 1), (737, 2), (738, 3), (739, 4), (740, 5), (741, 6), (742, 0), (743, 1), (744, 2), (745, 3), (746, 4), (747, 5), (748, 6), (749, 0), (750, 1), (751, 2), (752, 3), (753, 4), (754, 5), (755, 6), (756, 0), (757, 1), (758, 2), (759, 3), (760, 4), (761, 5), (762, 6), (763, 0), (764, 1), (765, 2), (766, 3), (767, 4), (768, 5), (769, 6), (770, 0), (771, 1), (772, 2), (773, 3), (774, 4), (775, 5), (776, 6), (777, 0), (778, 1), (779, 2), (780, 3), (781, 4), (782, 5), (783, 6), (784, 0), (785, 1), (786, 2), (787, 3), (788, 4), (789, 5), (790, 6), (791, 0), (792, 1), (793, 2), (794, 3), (795, 4), (796, 5), (797, 6), (798, 0), (799, 1), (800, 2), (801, 3), (802, 4), (803, 5), (804, 6), (805, 0), (806, 1), (807, 2), (808, 3), (809, 4), (810, 5), (811, 6), (812, 0), (813, 1), (814, 2), (815, 3), (816, 4), (817, 5), (818, 6), (819, 0), (820, 1), (821, 2), (822, 3), (823, 4), (824, 5), (825, 6), (826, 0), (827, 1), (828, 2), (829, 3), (830, 4), (831, 5), (832, 6), (833, 0), (834, 1), (835, 2), (836, 3), (837, 4), (838, 5), (839, 6), (840, 0), (841, 1), (842, 2), (843, 3), (844, 4), (845, 5), (846, 6), (847, 0), (848, 1), (849, 2), (850, 3), (851, 4), (852, 5), (853, 6), (854, 0), (855, 1), (856, 2), (857, 3), (858, 4), (859, 5), (860, 6), (861, 0), (862, 1), (863, 2), (864, 3), (865, 4), (866, 5), (867, 6), (868, 0), (869, 1), (870, 2), (871, 3), (872, 4), (873, 5), (874, 6), (875, 0), (876, 1), (877, 2), (878, 3), (879, 4), (880, 5), (881, 6), (882, 0), (883, 1), (884, 2), (885, 3), (886, 4), (887, 5), (888, 6), (889, 0), (890, 1), (891, 2), (892, 3), (893, 4), (894, 5), (895, 6), (896, 0), (897, 1), (898, 2), (899, 3), (900, 4), (901, 5), (902, 6), (903, 0), (904, 1), (905, 2), (906, 3), (907, 4), (908, 5), (909, 6), (910, 0), (911, 1), (912, 2), (913, 3), (914, 4), (915, 5), (916, 6), (917, 0), (918, 1), (919, 2), (920, 3), (921, 4), (922, 5), (923, 6), (924, 0), (925, 1), (926, 2), (927, 3), (928, 4), (929, 5), (930, 6), (931, 0), (932, 1), (933, 2), (934, 3), (935, 4), (936, 5), (937, 6), (938, 0), (939, 1), (940, 2), (941, 3), (942, 4), (943, 5), (944, 6), (945, 0), (946, 1), (947, 2), (948, 3), (949, 4), (950, 5), (951, 6), (952, 0), (953, 1), (954, 2), (955, 3), (956, 4), (957, 5), (958, 6), (959, 0), (960, 1), (961, 2), (962, 3), (963, 4), (964, 5), (965, 6), (966, 0), (967, 1), (968, 2), (969, 3), (970, 4), (971, 5), (972, 6), (973, 0), (974, 1), (975, 2), (976, 3), (977, 4), (978, 5), (979, 6), (980, 0), (981, 1), (982, 2), (983, 3), (984, 4), (985, 5), (986, 6), (987, 0), (988, 1), (989, 2), (990, 3), (991, 4), (992, 5), (993, 6), (994, 0), (995, 1), (996, 2), (997, 3), (998, 4), (999, 5), (1000, 6), (1001, 0), (1002, 1), (1003, 2), (1004, 3), (1005, 4), (1006, 5), (1007, 6), (1008, 0), (1009, 1), (1010, 2), (1011, 3), (1012, 4), (1013, 5), (1014, 6), (1015, 0), (1016, 1), (1017, 2), (1018, 3), (1019, 4), (1020, 5), (1021, 6), (1022, 0), (1023, 1);
+BEGIN;
+INSERT INTO t VALUES (1024, 0);
+DELETE FROM t WHERE id = 1024;
+ROLLBACK;
+UPDATE t SET k = 100 WHERE id = 5;
+DELETE FROM t WHERE k = 3;
+SELECT COUNT(*) FROM t;
+SELECT * FROM t WHERE id < 8;
+INSERT INTO t VALUES (2000, 1);
+DELETE FROM t WHERE id = 2000;
+SELECT COUNT(*) FROM t;
+exit;
@@ -0,0 +1,34 @@
+# runs one .sql script through the REPL and compares what it prints with the expected output
+#   cmake -DDB=<db_cpp> -DSCRIPT=<x.sql> [-DRESTART=<y.sql>] -DEXPECTED=<x.out> -DWORK_DIR=<dir> -P run_script.cmake
+# each test gets its own work dir, the REPL replays db_commands.log from the cwd on startup. RESTART
+# is run by a second REPL in the same dir after SCRIPT, so it sees the database its log rebuilds
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+set(actual "")
+foreach (script IN ITEMS "${SCRIPT}" "${RESTART}")
+    if (script STREQUAL "")
+        continue()
+    endif ()
+    execute_process(
+            COMMAND "${DB}"
+            INPUT_FILE "${script}"
+            OUTPUT_VARIABLE output
+            ERROR_VARIABLE output
+            WORKING_DIRECTORY "${WORK_DIR}"
+            RESULT_VARIABLE result
+    )
+    string(APPEND actual "${output}")
+    # a script exits with 1 when a statement in it failed, which the expected output shows. only a
+    # crash, where result is the signal instead of an exit code, fails here
+    if (NOT result MATCHES "^[0-9]+$")
+        message(FATAL_ERROR "${DB} failed on ${script}: ${result}\n${actual}")
+    endif ()
+endforeach ()
+
+file(READ "${EXPECTED}" expected)
+if (NOT actual STREQUAL expected)
+    file(WRITE "${WORK_DIR}/actual.out" "${actual}")
+    message(FATAL_ERROR "output differs from ${EXPECTED}, see ${WORK_DIR}/actual.out:\n${actual}")
+endif ()
@@ -0,0 +1,94 @@
+// two connections of one server prepare statements under the same name for different tables and
+// execute them interleaved. the command log the server wrote is then replayed into a fresh database
+// the way db_cpp does on startup, and both databases have to hold the same rows
+
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Client.hpp"
+#include "Script.hpp"
+#include "Server.hpp"
+
+static auto check(Client& client, std::string_view statement) -> void {
+    auto response = client.query(statement);
+    if (response.status != ResponseStatus::OK) {
+        throw std::runtime_error(fmt::format("'{}' failed: {}", statement, response.body));
+    }
+}
+
+static auto contents(Session& session, StringSink& sink) -> std::string {
+    sink.clear();
+    for (const char* query : {"SELECT * FROM t1 ORDER BY id", "SELECT * FROM t2 ORDER BY id"}) {
+        session.run(query);
+    }
+    return sink.text();
+}
+
+int main() {
+    std::vector<std::string> log;
+    std::mutex log_mutex;
+    auto logger = [&](const std::vector<std::string>& commands) {
+        std::lock_guard lock(log_mutex);
+        log.insert(log.end(), commands.begin(), commands.end());
+    };
+
+    Database live("live");
+    ServerOptions options;
+    options.port = 0;
+    options.socket_path = fmt::format("/tmp/db_cpp_replay_test.{}.sock", getpid());
+    options.threads = 2;
+    Server server(live, options, logger);
+    server.start();
+    std::thread serving([&server] { server.run(); });
+
+    try {
+        auto a = Client::connectUnix(options.socket_path);
+        auto b = Client::connectUnix(options.socket_path);
+        check(a, "CREATE TABLE t1 (id INTEGER, x FLOAT, s STRING)");
+        check(a, "CREATE TABLE t2 (id INTEGER, x FLOAT, s STRING)");
+        check(a, "PREPARE ins AS INSERT INTO t1 (id, x, s) VALUES ($1, $2, $3)");
+        check(b, "PREPARE ins AS INSERT INTO t2 (id, x, s) VALUES ($1, $2, $3)");
+        check(a, "EXECUTE ins(1, 1.5, 'a')");
+        check(b, "EXECUTE ins(2, 2, \"it's\")");
+        check(b, "BEGIN");
+        check(b, "EXECUTE ins(3, 0.1, 'b')");
+        check(b, "PREPARE ins AS DELETE FROM t2 WHERE id = $1");
+        check(a, "EXECUTE ins(4, -3, NULL)");
+        check(b, "EXECUTE ins(2)");
+        check(b, "COMMIT");
+        check(a, "PREPARE up AS UPDATE t1 SET x = $1 WHERE id = $2");
+        check(a, "EXECUTE up(9.25, 4)");
+    } catch (const std::exception& e) {
+        fmt::print(stderr, "{}\n", e.what());
+        server.stop();
+        serving.join();
+        return 1;
+    }
+    server.stop();
+    serving.join();
+
+    StringSink live_sink;
+    Session live_session(live, live_sink);
+    std::string expected = contents(live_session, live_sink);
+
+    std::ostringstream text;
+    for (const auto& line : log) text << line << '\n';
+    std::istringstream input(text.str());
+    Database replayed("replayed");
+    StringSink replay_sink;
+    Session replay_session(replayed, replay_sink);
+    ScriptRunner(replay_session).run(input, StatementReader::Mode::LINE);
+    std::string actual = contents(replay_session, replay_sink);
+
+    if (actual != expected) {
+        fmt::print(stderr, "replayed log:\n{}\nlive:\n{}\nreplayed:\n{}\n", text.str(), expected, actual);
+        return 1;
+    }
+    fmt::print("ok, {} statements replayed\n", log.size());
+    return 0;
+}
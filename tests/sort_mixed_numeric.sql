@@ -0,0 +1,9 @@
+CREATE TABLE m (id INTEGER, x FLOAT);
+INSERT INTO m VALUES (1, 75000), (2, 1.5), (3, 99999.5), (4, 3);
+SELECT * FROM m ORDER BY x;
+SELECT * FROM m ORDER BY x DESC;
+SELECT * FROM m WHERE id < 4 AND id > 1 ORDER BY x DESC;
+CREATE TABLE f (id INTEGER, x FLOAT);
+INSERT INTO f VALUES (1, 2.5), (2, 0.5), (3, 1.5);
+SELECT * FROM f ORDER BY x;
+exit;